@@ -0,0 +1,325 @@
+// clang: MatousFormat
+/**  \file
+     \brief Defines batchLKF - an engine, running many identical Linear Kalman Filters at once in a structure-of-arrays layout.
+     \author Matouš Vrba - vrbamato@fel.cvut.cz
+ */
+#ifndef BATCH_LKF_H
+#define BATCH_LKF_H
+
+#include <mrs_lib/lkf.h>
+#include <cassert>
+
+namespace mrs_lib
+{
+
+  /* class batchLKF //{ */
+  /**
+  * \brief Engine, running \f$ N \f$ Linear Kalman filters \cite LKF with identical system matrices at once.
+  *
+  * When many small filters are used (eg. one LKF per tracked target and per axis), most of the time is spent in the overhead
+  * of the individual calls rather than in the actual computation. This class holds the states and covariances of all
+  * the filters in a structure-of-arrays layout - each element of the state vectors and of the covariance matrices is stored
+  * in a contiguous column over all the filters. The predict() and correct() methods are then applied to all the filters in
+  * one sweep, where each operation works with whole columns, so it is vectorized by the compiler and the overhead is only paid once.
+  * Zero elements of the system matrices are skipped, which makes the prediction cheap for the usual sparse \f$ \mathbf{A} \f$.
+  *
+  * Unlike the LKF, this class keeps the states of the filters internally and the steps are applied in place. The get()
+  * and set() methods may be used to access the state and covariance of a single filter as the statecov_t of the LKF.
+  * All the filters share the system matrices and the process and measurement noise covariance matrices.
+  *
+  * \tparam n_states         number of states of the system (length of the \f$ \mathbf{x} \f$ vector).
+  * \tparam n_inputs         number of inputs of the system (length of the \f$ \mathbf{u} \f$ vector).
+  * \tparam n_measurements   number of measurements of the system (length of the \f$ \mathbf{z} \f$ vector).
+  *
+  */
+  template <int n_states, int n_inputs, int n_measurements>
+  class batchLKF
+  {
+  public:
+    /* batchLKF definitions (typedefs, constants etc) //{ */
+    static constexpr int n = n_states;                   /*!< \brief Length of the state vector of the system. */
+    static constexpr int m = n_inputs;                   /*!< \brief Length of the input vector of the system. */
+    static constexpr int p = n_measurements;             /*!< \brief Length of the measurement vector of the system. */
+    using lkf_t = LKF<n, m, p>;                          /*!< \brief The corresponding single LKF. */
+
+    using x_t = typename lkf_t::x_t;                     /*!< \brief State vector type \f$n \times 1\f$ */
+    using u_t = typename lkf_t::u_t;                     /*!< \brief Input vector type \f$m \times 1\f$ */
+    using z_t = typename lkf_t::z_t;                     /*!< \brief Measurement vector type \f$p \times 1\f$ */
+    using P_t = typename lkf_t::P_t;                     /*!< \brief State uncertainty covariance matrix type \f$n \times n\f$ */
+    using R_t = typename lkf_t::R_t;                     /*!< \brief Measurement noise covariance matrix type \f$p \times p\f$ */
+    using Q_t = typename lkf_t::Q_t;                     /*!< \brief Process noise covariance matrix type \f$n \times n\f$ */
+    using statecov_t = typename lkf_t::statecov_t;       /*!< \brief Helper struct for passing around the state and its covariance in one variable */
+    using A_t = typename lkf_t::A_t;                     /*!< \brief System transition matrix type \f$n \times n\f$ */
+    using B_t = typename lkf_t::B_t;                     /*!< \brief Input to state mapping matrix type \f$n \times m\f$ */
+    using H_t = typename lkf_t::H_t;                     /*!< \brief State to measurement mapping matrix type \f$p \times n\f$ */
+    using inverse_exception = typename lkf_t::inverse_exception; /*!< \brief Thrown when the measurement noise covariance matrix is not positive definite */
+
+    using xs_t = Eigen::Matrix<double, Eigen::Dynamic, n>;      /*!< \brief States of all the filters \f$N \times n\f$ (one row per filter) */
+    using us_t = Eigen::Matrix<double, Eigen::Dynamic, m>;      /*!< \brief Inputs of all the filters \f$N \times m\f$ (one row per filter) */
+    using zs_t = Eigen::Matrix<double, Eigen::Dynamic, p>;      /*!< \brief Measurements of all the filters \f$N \times p\f$ (one row per filter) */
+    using Ps_t = Eigen::Matrix<double, Eigen::Dynamic, n * n>;  /*!< \brief Covariances of all the filters \f$N \times n^2\f$ (one row per filter, element \f$(i, j)\f$ in column \f$in + j\f$) */
+    //}
+
+  public:
+  /*!
+    * \brief Convenience default constructor.
+    *
+    * This constructor should not be used if applicable. If used, the main constructor has to be called afterwards,
+    * before using this class, otherwise the object is invalid (not initialized).
+    */
+    batchLKF(){};
+
+  /*!
+    * \brief The main constructor.
+    *
+    * \param A             The state transition matrix.
+    * \param B             The input to state mapping matrix.
+    * \param H             The state to measurement mapping matrix.
+    * \param n_filters     Number of the filters. Their states and covariances are initialized to zero.
+    */
+    batchLKF(const A_t& A, const B_t& B, const H_t& H, const int n_filters = 0) : A(A), B(B), H(H)
+    {
+      resize(n_filters);
+    };
+
+    /* size() method //{ */
+  /*!
+    * \brief Returns the number of the filters.
+    *
+    * \return            Number of the filters.
+    */
+    int size() const
+    {
+      return int(m_xs.rows());
+    };
+    //}
+
+    /* resize() method //{ */
+  /*!
+    * \brief Changes the number of the filters.
+    *
+    * States and covariances of the filters, which are kept, are not changed. The new filters are initialized to zero.
+    *
+    * \param n_filters   The new number of the filters.
+    */
+    void resize(const int n_filters)
+    {
+      m_xs.conservativeResizeLike(xs_t::Zero(n_filters, n));
+      m_Ps.conservativeResizeLike(Ps_t::Zero(n_filters, n * n));
+    };
+    //}
+
+    /* get() method //{ */
+  /*!
+    * \brief Returns the state and covariance of a single filter.
+    *
+    * \param idx         Index of the filter.
+    * \return            The state and covariance of the filter.
+    */
+    statecov_t get(const int idx) const
+    {
+      statecov_t ret;
+      ret.x = m_xs.row(idx).transpose();
+      for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+          ret.P(i, j) = m_Ps(idx, i * n + j);
+      return ret;
+    };
+    //}
+
+    /* set() method //{ */
+  /*!
+    * \brief Sets the state and covariance of a single filter (eg. to initialize or reset it).
+    *
+    * \param idx         Index of the filter.
+    * \param sc          The new state and covariance of the filter.
+    */
+    void set(const int idx, const statecov_t& sc)
+    {
+      m_xs.row(idx) = sc.x.transpose();
+      for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+          m_Ps(idx, i * n + j) = sc.P(i, j);
+    };
+    //}
+
+    /* states() method //{ */
+  /*!
+    * \brief Returns the states of all the filters.
+    *
+    * \return            The states of all the filters, one row per filter.
+    */
+    const xs_t& states() const
+    {
+      return m_xs;
+    };
+    //}
+
+    /* covariances() method //{ */
+  /*!
+    * \brief Returns the covariances of all the filters.
+    *
+    * \return            The covariances of all the filters, one row per filter (element \f$(i, j)\f$ of the covariance matrix in column \f$in + j\f$).
+    */
+    const Ps_t& covariances() const
+    {
+      return m_Ps;
+    };
+    //}
+
+    /* predict() method //{ */
+  /*!
+    * \brief Applies the prediction (time) step to all the filters.
+    *
+    * \param us          The input vectors of the filters, one row per filter.
+    * \param Q           The process noise covariance matrix to be used for prediction.
+    * \param dt          Used to scale the process noise covariance \p Q (see LKF::predict()).
+    */
+    void predict(const us_t& us, const Q_t& Q, const double dt)
+    {
+      assert(us.rows() == m_xs.rows());
+      predict_state();
+      for (int i = 0; i < n; i++)
+        for (int k = 0; k < m; k++)
+          if (B(i, k) != 0.0)
+            m_xs.col(i) += B(i, k) * us.col(k);
+      predict_covariance(Q, dt);
+    };
+
+  /*!
+    * \brief Applies the prediction (time) step to all the filters with the same input.
+    *
+    * \param u           The input vector, used for all the filters.
+    * \param Q           The process noise covariance matrix to be used for prediction.
+    * \param dt          Used to scale the process noise covariance \p Q (see LKF::predict()).
+    */
+    void predict(const u_t& u, const Q_t& Q, const double dt)
+    {
+      predict_state();
+      const x_t Bu = B * u;
+      for (int i = 0; i < n; i++)
+        if (Bu(i) != 0.0)
+          m_xs.col(i).array() += Bu(i);
+      predict_covariance(Q, dt);
+    };
+    //}
+
+    /* correct() method //{ */
+  /*!
+    * \brief Applies the correction (update, measurement, data) step to all the filters.
+    *
+    * The measurement is decorrelated using the Cholesky factor of \p R and applied as \f$ p \f$ scalar measurements, so that
+    * no matrix has to be inverted for the individual filters (see also LKF::setSequentialCorrection()).
+    *
+    * \param zs          The measurement vectors of the filters, one row per filter.
+    * \param R           The measurement noise covariance matrix to be used for correction (must be positive definite).
+    */
+    void correct(const zs_t& zs, const R_t& R)
+    {
+      assert(zs.rows() == m_xs.rows());
+      const Eigen::LLT<R_t> llt(R);
+      if (llt.info() != Eigen::Success)
+        throw inverse_exception();
+      // decorrelate the measurements, so that they can be applied as p independent scalar measurements with a unit variance
+      const H_t H_dec = llt.matrixL().solve(H);
+      m_zs_dec.noalias() = zs * llt.matrixL().solve(R_t::Identity()).transpose();
+
+      const int N = size();
+      xs_t& Ph = m_Ph;
+      xs_t& K = m_K;
+      Eigen::ArrayXd& inn = m_inn;
+      Eigen::ArrayXd& s_inv = m_s_inv;
+      Ph.resize(N, n);
+      K.resize(N, n);
+      inn.resize(N);
+      s_inv.resize(N);
+      for (int it = 0; it < p; it++)
+      {
+        const x_t h = H_dec.row(it).transpose();
+
+        // Ph = P*h, s = h^T*P*h + 1, inn = z - h^T*x
+        Ph.setZero();
+        for (int i = 0; i < n; i++)
+          for (int j = 0; j < n; j++)
+            if (h(j) != 0.0)
+              Ph.col(i) += h(j) * m_Ps.col(i * n + j);
+        s_inv.setOnes();
+        inn = m_zs_dec.col(it).array();
+        for (int i = 0; i < n; i++)
+        {
+          if (h(i) == 0.0)
+            continue;
+          s_inv += h(i) * Ph.col(i).array();
+          inn -= h(i) * m_xs.col(i).array();
+        }
+        s_inv = s_inv.inverse();
+
+        // K = Ph/s, x += K*inn, P -= K*(Ph)^T
+        for (int i = 0; i < n; i++)
+        {
+          K.col(i).array() = Ph.col(i).array() * s_inv;
+          m_xs.col(i).array() += K.col(i).array() * inn;
+        }
+        for (int i = 0; i < n; i++)
+          for (int j = 0; j < n; j++)
+            m_Ps.col(i * n + j).array() -= K.col(i).array() * Ph.col(j).array();
+      }
+    };
+    //}
+
+  public:
+    A_t A;  /*!< \brief The system transition matrix \f$n \times n\f$ */
+    B_t B;  /*!< \brief The input to state mapping matrix \f$n \times m\f$ */
+    H_t H;  /*!< \brief The state to measurement mapping matrix \f$p \times n\f$ */
+
+  private:
+    xs_t m_xs;  // states of the filters, one row per filter
+    Ps_t m_Ps;  // covariances of the filters, one row per filter
+    xs_t m_Ax;  // preallocated buffer for the state prediction
+    Ps_t m_AP;  // preallocated buffer for the covariance prediction
+    zs_t m_zs_dec;  // preallocated buffers for the correction
+    xs_t m_Ph;
+    xs_t m_K;
+    Eigen::ArrayXd m_inn;
+    Eigen::ArrayXd m_s_inv;
+
+  private:
+    /* predict_state() method //{ */
+    // x = A*x (the input is added by the caller)
+    void predict_state()
+    {
+      m_Ax.noalias() = m_xs * A.transpose();
+      m_xs.swap(m_Ax);
+    }
+    //}
+
+    /* predict_covariance() method //{ */
+    // P = A*P*A^T + dt*Q, zero elements of A are skipped
+    void predict_covariance(const Q_t& Q, const double dt)
+    {
+      m_AP.setZero(m_Ps.rows(), n * n);
+      for (int i = 0; i < n; i++)
+        for (int k = 0; k < n; k++)
+          if (A(i, k) != 0.0)
+            for (int j = 0; j < n; j++)
+              m_AP.col(i * n + j) += A(i, k) * m_Ps.col(k * n + j);
+
+      for (int i = 0; i < n; i++)
+      {
+        for (int j = 0; j < n; j++)
+        {
+          auto col = m_Ps.col(i * n + j);
+          col.setConstant(dt * Q(i, j));
+          for (int k = 0; k < n; k++)
+            if (A(j, k) != 0.0)
+              col += A(j, k) * m_AP.col(i * n + k);
+        }
+      }
+    }
+    //}
+  };
+  //}
+
+}  // namespace mrs_lib
+
+#endif // BATCH_LKF_H
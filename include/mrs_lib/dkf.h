@@ -10,6 +10,7 @@
 #include <mrs_lib/lkf.h>
 #include <mrs_lib/geometry/misc.h>
 #include <iostream>
+#include <vector>
 
 namespace mrs_lib
 {
@@ -52,6 +53,26 @@ namespace mrs_lib
     using pt3_t = mrs_lib::geometry::vec3_t;
     using pt2_t = mrs_lib::geometry::vec2_t;
     using vec3_t = mrs_lib::geometry::vec3_t;
+
+    /*!
+      * \brief Helper struct defining a line measurement (see correctLine()).
+      */
+    struct line_t
+    {
+      pt3_t origin;     /*!< \brief A point lying on the measurement line. */
+      vec3_t direction; /*!< \brief A vector defining the span of the measurement line. */
+      double variance;  /*!< \brief Variance of the measurement in the direction perpendicular to the line (must be positive). */
+    };
+
+    /*!
+      * \brief Helper struct defining a plane measurement (see correctPlane()).
+      */
+    struct plane_t
+    {
+      pt3_t origin;    /*!< \brief A point lying on the measurement plane. */
+      vec3_t normal;   /*!< \brief The normal vector of the measurement plane. */
+      double variance; /*!< \brief Variance of the measurement in the direction perpendicular to the plane (must be positive). */
+    };
     //}
 
   public:
@@ -151,6 +172,72 @@ namespace mrs_lib
       return this->correction_impl(sc, z, R, H);
     };
     //}
+
+    /* correctBatch() method //{ */
+  /*!
+    * \brief Applies the correction (update, measurement, data) step of the Kalman filter using multiple line and plane measurements at once.
+    *
+    * The result is the same as if correctLine() and correctPlane() were called for each of the measurements in sequence
+    * (up to numerical errors), but only a single update of the covariance matrix is done, which is significantly faster
+    * for more than a few measurements.
+    *
+    * All the measurements constrain only the first three states, so the stacked measurement matrix has the block form
+    * \f$ \mathbf{H} = \mathbf{G} \left[ \mathbf{I}_3 \; \mathbf{0} \right] \f$ and the stacked measurement noise matrix
+    * \f$ \mathbf{R} \f$ is diagonal. The individual measurements are therefore first accumulated into a \f$ 3 \times 3 \f$
+    * information matrix \f$ \mathbf{Y} = \mathbf{G}^\intercal \mathbf{R}^{-1} \mathbf{G} \f$ and a corresponding information
+    * vector and the correction is then applied using the push-through identity
+    * \f$ \mathbf{K} = \mathbf{P} \mathbf{H}^\intercal \left( \mathbf{H} \mathbf{P} \mathbf{H}^\intercal + \mathbf{R} \right)^{-1}
+    * = \mathbf{P}_{:,1:3} \left( \mathbf{I}_3 + \mathbf{Y} \mathbf{P}_{1:3,1:3} \right)^{-1} \mathbf{G}^\intercal \mathbf{R}^{-1} \f$,
+    * so only a \f$ 3 \times 3 \f$ system has to be solved regardless of the number of measurements.
+    *
+    * \param sc             The state and covariance to which the correction step is to be applied.
+    * \param lines          The line measurements (see correctLine() for their meaning).
+    * \param planes         The plane measurements (see correctPlane() for their meaning).
+    * \return               The state and covariance after the correction update.
+    */
+    virtual std::enable_if_t<(n > 3), statecov_t> correctBatch(const statecov_t& sc, const std::vector<line_t>& lines, const std::vector<plane_t>& planes = {}) const
+    {
+      // accumulate the information matrix Y and the information vector y - Y*x (i.e. of the innovation)
+      mat3_t Y = mat3_t::Zero();
+      vec3_t y = vec3_t::Zero();
+      const vec3_t pos = sc.x.template head<3>();
+      for (const auto& line : lines)
+      {
+        assert(line.direction.norm() > 0.0);
+        assert(line.variance > 0.0);
+        // the line constrains the state in the two directions perpendicular to it, N*N^T is a projector to this null space
+        const vec3_t dir = line.direction.normalized();
+        const mat3_t Y_line = (mat3_t::Identity() - dir * dir.transpose()) / line.variance;
+        Y += Y_line;
+        y += Y_line * (line.origin - pos);
+      }
+      for (const auto& plane : planes)
+      {
+        assert(plane.normal.norm() > 0.0);
+        assert(plane.variance > 0.0);
+        // the plane constrains the state in the direction of its normal
+        const vec3_t normal = plane.normal.normalized();
+        const mat3_t Y_plane = normal * normal.transpose() / plane.variance;
+        Y += Y_plane;
+        y += Y_plane * (plane.origin - pos);
+      }
+
+      // the first three columns of P - the covariance of the state with the measured part of the state
+      const Eigen::Matrix<double, n, 3> C = sc.P.template leftCols<3>();
+      const mat3_t P33 = C.template topRows<3>();
+      // I + Y*P33 is always invertible for a positive definite P33 and a positive semi-definite Y
+      const Eigen::PartialPivLU<mat3_t> lu(mat3_t::Identity() + Y * P33);
+      mat3_t T = lu.solve(Y);
+      // T = Y*(I + P33*Y)^-1 is symmetric - remove the numerical errors
+      T = 0.5 * (T + T.transpose()).eval();
+
+      statecov_t ret;
+      ret.x = sc.x + C * lu.solve(y);
+      ret.P = sc.P - C * T * C.transpose();
+      ret.stamp = sc.stamp;
+      return ret;
+    };
+    //}
   };
   //}
 
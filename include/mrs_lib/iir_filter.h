@@ -5,6 +5,10 @@
 #define IIR_FILTER_H
 
 #include <ros/ros.h>
+#include <Eigen/Dense>
+#include <array>
+#include <cassert>
+#include <vector>
 
 namespace mrs_lib
 {
@@ -24,6 +28,114 @@ private:
   std::vector<double> buffer_;
 };
 
+/* class IirFilterN //{ */
+
+/**
+ * \brief IIR filter with the order and the number of channels known at compile time.
+ *
+ * All channels are filtered by the same filter in lockstep, so the filter of a vector (e.g. the six axes of an IMU) is vectorized
+ * over the channels. The filter is implemented in the transposed direct form II, so no delay line has to be shifted, and the block
+ * API process() keeps the filter state in local variables for the whole block of samples.
+ *
+ * \tparam order     order of the filter (the number of the coefficients \p a and \p b is order + 1).
+ * \tparam channels  number of the filtered channels.
+ */
+template <int order, int channels>
+class IirFilterN {
+
+  static_assert(order > 0, "the order of the filter must be positive");
+  static_assert(channels > 0, "the number of the channels must be positive");
+
+public:
+  using coeffs_t  = std::array<double, order + 1>;                      /*!< \brief Type of the coefficients of the numerator or the denominator */
+  using vec_t     = Eigen::Matrix<double, channels, 1>;                 /*!< \brief Type of one sample of all the channels */
+  using samples_t = Eigen::Matrix<double, channels, Eigen::Dynamic>;    /*!< \brief Type of a block of samples (one sample per column) */
+
+  /*!
+   * \brief The main constructor.
+   *
+   * The coefficients are normalized by a[0], which must be non-zero.
+   *
+   * \param a  coefficients of the denominator of the transfer function.
+   * \param b  coefficients of the numerator of the transfer function.
+   */
+  IirFilterN(const coeffs_t& a, const coeffs_t& b) : state_(state_t::Zero()) {
+    assert(a[0] != 0.0);
+    for (int i = 0; i <= order; i++) {
+      a_[i] = a[i] / a[0];
+      b_[i] = b[i] / a[0];
+    }
+  }
+
+  /*!
+   * \brief Filter one sample of all the channels.
+   *
+   * \param input  the new sample.
+   * \return       the filtered sample.
+   */
+  vec_t iterate(const vec_t& input) {
+    return step(input.array(), state_).matrix();
+  }
+
+  /*!
+   * \brief Filter a block of samples of all the channels.
+   *
+   * The filtering may be done in-place (\p in and \p out may be the same matrix).
+   *
+   * \param in   the new samples (one sample per column).
+   * \param out  the filtered samples (must have the same number of columns as \p in).
+   */
+  void process(const Eigen::Ref<const samples_t>& in, Eigen::Ref<samples_t> out) {
+    assert(in.cols() == out.cols());
+    // the state is kept in a local variable so that it can stay in the registers for the whole block
+    state_t state = state_;
+    for (Eigen::Index it = 0; it < in.cols(); it++) {
+      out.col(it) = step(in.col(it).array(), state).matrix();
+    }
+    state_ = state;
+  }
+
+  /*!
+   * \brief Filter a block of samples of all the channels, stored in a plain buffer.
+   *
+   * The samples are interleaved (the values of all the channels of the first sample, then of the second sample, etc.).
+   *
+   * \param in         the new samples.
+   * \param out        the filtered samples (may be the same buffer as \p in).
+   * \param n_samples  the number of samples (the buffers contain n_samples * channels values).
+   */
+  void process(const double* in, double* out, const size_t n_samples) {
+    process(Eigen::Map<const samples_t>(in, channels, n_samples), Eigen::Map<samples_t>(out, channels, n_samples));
+  }
+
+  /*!
+   * \brief Reset the state of the filter to zero.
+   */
+  void reset() {
+    state_.setZero();
+  }
+
+private:
+  using arr_t   = Eigen::Array<double, channels, 1>;
+  using state_t = Eigen::Array<double, channels, order>;
+
+  coeffs_t a_;
+  coeffs_t b_;
+  state_t  state_;
+
+  // one step of the transposed direct form II for all the channels
+  arr_t step(const arr_t& input, state_t& state) const {
+    const arr_t output = b_[0] * input + state.col(0);
+    for (int i = 0; i < order - 1; i++) {
+      state.col(i) = b_[i + 1] * input - a_[i + 1] * output + state.col(i + 1);
+    }
+    state.col(order - 1) = b_[order] * input - a_[order] * output;
+    return output;
+  }
+};
+
+//}
+
 }  // namespace mrs_lib
 
 #endif
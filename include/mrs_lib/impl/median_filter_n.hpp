@@ -0,0 +1,255 @@
+#ifndef MEDIAN_FILTER_N_HPP
+#define MEDIAN_FILTER_N_HPP
+
+/**  \file
+     \brief Implements MedianFilterN - a class implementing a multi-channel median filter.
+     \author Matouš Vrba - matous.vrba@fel.cvut.cz
+ */
+
+#include <mrs_lib/median_filter_n.h>
+#include <algorithm>
+
+namespace mrs_lib
+{
+  /* constructor overloads //{ */
+
+  template <int N>
+  MedianFilterN<N>::MedianFilterN(const size_t buffer_length, const vec_t& min_value, const vec_t& max_value, const vec_t& max_diff)
+    : m_buffer(buffer_length, N),
+      m_first(0),
+      m_size(0),
+      m_sorted(buffer_length, N),
+      m_min_valid(min_value),
+      m_max_valid(max_value),
+      m_max_diff(max_diff)
+  {
+  }
+
+  template <int N>
+  MedianFilterN<N>::MedianFilterN()
+    : m_buffer(0, N),
+      m_first(0),
+      m_size(0),
+      m_sorted(0, N),
+      m_min_valid(vec_t::Zero()),
+      m_max_valid(vec_t::Zero()),
+      m_max_diff(vec_t::Zero())
+  {
+  }
+
+  template <int N>
+  MedianFilterN<N>::MedianFilterN(const MedianFilterN& other)
+  {
+    *this = other;
+  }
+
+  //}
+
+  /* operator=() method //{ */
+  template <int N>
+  MedianFilterN<N>& MedianFilterN<N>::operator=(const MedianFilterN& other)
+  {
+    std::scoped_lock lck(other.m_mtx, m_mtx);
+
+    m_buffer = other.m_buffer;
+    m_first = other.m_first;
+    m_size = other.m_size;
+    m_sorted = other.m_sorted;
+
+    // parameters specified by the user
+    m_min_valid = other.m_min_valid;
+    m_max_valid = other.m_max_valid;
+    m_max_diff = other.m_max_diff;
+
+    return *this;
+  }
+  //}
+
+  /* add() method //{ */
+  template <int N>
+  void MedianFilterN<N>::add(const vec_t& value)
+  {
+    std::scoped_lock lck(m_mtx);
+    const size_t length = m_buffer.rows();
+    // a zero-length buffer cannot hold any values
+    if (length == 0)
+      return;
+
+    if (m_size == length)
+    {
+      // the buffer is full - the oldest row is replaced by the new values
+      for (int it = 0; it < N; it++)
+        replaceSorted(m_sorted.col(it).data(), m_buffer(m_first, it), value(it));
+      m_buffer.row(m_first) = value.transpose();
+      m_first = (m_first + 1) % length;
+    }
+    else
+    {
+      for (int it = 0; it < N; it++)
+        insertSorted(m_sorted.col(it).data(), value(it));
+      m_buffer.row((m_first + m_size) % length) = value.transpose();
+      m_size++;
+    }
+  }
+  //}
+
+  /* check() method //{ */
+  template <int N>
+  typename MedianFilterN<N>::mask_t MedianFilterN<N>::check(const vec_t& value)
+  {
+    std::scoped_lock lck(m_mtx);
+    // check if all constraints are met for all the channels at once
+    const vec_t diff = m_size == 0 ? vec_t::Zero() : vec_t((median() - value).cwiseAbs());
+    return value.array() > m_min_valid.array() && value.array() < m_max_valid.array() && diff.array() < m_max_diff.array();
+  }
+  //}
+
+  /* addCheck() method //{ */
+  template <int N>
+  typename MedianFilterN<N>::mask_t MedianFilterN<N>::addCheck(const vec_t& value)
+  {
+    std::scoped_lock lck(m_mtx);
+    add(value);
+    return check(value);
+  }
+  //}
+
+  /* clear() method //{ */
+  template <int N>
+  void MedianFilterN<N>::clear()
+  {
+    std::scoped_lock lck(m_mtx);
+    m_first = 0;
+    m_size = 0;
+  }
+  //}
+
+  /* full() method //{ */
+  template <int N>
+  bool MedianFilterN<N>::full() const
+  {
+    std::scoped_lock lck(m_mtx);
+    return m_size == size_t(m_buffer.rows());
+  }
+  //}
+
+  /* median() method //{ */
+  template <int N>
+  typename MedianFilterN<N>::vec_t MedianFilterN<N>::median() const
+  {
+    std::scoped_lock lck(m_mtx);
+    // check if there are even any numbers to calculate the median from
+    if (m_size == 0)
+      return vec_t::Constant(std::numeric_limits<double>::quiet_NaN());
+
+    // the "normal" case with an odd set
+    if (m_size % 2 == 1)
+      return m_sorted.row(m_size / 2).transpose();
+    // special case for a median of an even set of numbers
+    else
+      return (m_sorted.row(m_size / 2 - 1) + m_sorted.row(m_size / 2)).transpose() / 2.0;
+  }
+  //}
+
+  /* initialized() method //{ */
+  template <int N>
+  bool MedianFilterN<N>::initialized() const
+  {
+    std::scoped_lock lck(m_mtx);
+    return m_buffer.rows() > 0;
+  }
+  //}
+
+  /* setBufferLength() method //{ */
+  template <int N>
+  void MedianFilterN<N>::setBufferLength(const size_t buffer_length)
+  {
+    std::scoped_lock lck(m_mtx);
+    // linearize the ring buffer and keep the oldest values that fit into the new one
+    const size_t length = m_buffer.rows();
+    const size_t size = std::min(m_size, buffer_length);
+    buffer_t buffer(buffer_length, N);
+    for (size_t it = 0; it < size; it++)
+      buffer.row(it) = m_buffer.row((m_first + it) % length);
+    m_buffer = std::move(buffer);
+    m_first = 0;
+
+    // the median may change if some values are discarded
+    const bool discarded = size < m_size;
+    m_size = size;
+    m_sorted.conservativeResize(buffer_length, N);
+    if (discarded)
+    {
+      m_sorted.topRows(m_size) = m_buffer.topRows(m_size);
+      for (int it = 0; it < N; it++)
+        std::sort(m_sorted.col(it).data(), m_sorted.col(it).data() + m_size, less_t());
+    }
+  }
+  //}
+
+  /* setMinValue() method //{ */
+  template <int N>
+  void MedianFilterN<N>::setMinValue(const vec_t& min_value)
+  {
+    std::scoped_lock lck(m_mtx);
+    m_min_valid = min_value;
+  }
+  //}
+
+  /* setMaxValue() method //{ */
+  template <int N>
+  void MedianFilterN<N>::setMaxValue(const vec_t& max_value)
+  {
+    std::scoped_lock lck(m_mtx);
+    m_max_valid = max_value;
+  }
+  //}
+
+  /* setMaxDifference() method //{ */
+  template <int N>
+  void MedianFilterN<N>::setMaxDifference(const vec_t& max_diff)
+  {
+    std::scoped_lock lck(m_mtx);
+    m_max_diff = max_diff;
+  }
+  //}
+
+  /* insertSorted() method //{ */
+  // inserts the value to the first m_size sorted values of a channel (there must be a free space after them)
+  template <int N>
+  void MedianFilterN<N>::insertSorted(double* const sorted, const double value)
+  {
+    double* const end = sorted + m_size;
+    double* const pos = std::upper_bound(sorted, end, value, less_t());
+    std::move_backward(pos, end, end + 1);
+    *pos = value;
+  }
+  //}
+
+  /* replaceSorted() method //{ */
+  // replaces one occurence of the old value in the first m_size sorted values of a channel by the new value,
+  // only the values between the old and the new position are shifted
+  template <int N>
+  void MedianFilterN<N>::replaceSorted(double* const sorted, const double old_value, const double new_value)
+  {
+    const less_t less;
+    double* const end = sorted + m_size;
+    double* const old_pos = std::lower_bound(sorted, end, old_value, less);
+    if (less(new_value, old_value))
+    {
+      double* const pos = std::upper_bound(sorted, old_pos, new_value, less);
+      std::move_backward(pos, old_pos, old_pos + 1);
+      *pos = new_value;
+    }
+    else
+    {
+      double* const pos = std::upper_bound(old_pos + 1, end, new_value, less);
+      std::move(old_pos + 1, pos, old_pos);
+      *(pos - 1) = new_value;
+    }
+  }
+  //}
+
+}  // namespace mrs_lib
+
+#endif
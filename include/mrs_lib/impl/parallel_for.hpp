@@ -0,0 +1,132 @@
+// clang: MatousFormat
+
+#ifndef PARALLEL_FOR_HPP
+#define PARALLEL_FOR_HPP
+
+/**  \file
+     \brief Implements ParallelFor - a minimal thread pool, used internally by some of the estimators (e.g. UKF and RHEIV).
+     \author Matouš Vrba - vrbamato@fel.cvut.cz
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mrs_lib
+{
+  namespace impl
+  {
+    /* class ParallelFor //{ */
+    // a minimal thread pool, which runs the task for all indices from 0 to n_tasks-1 in parallel and waits for the results
+    class ParallelFor
+    {
+    public:
+      // n_threads is the total number of threads including the calling one
+      ParallelFor(const int n_threads)
+      {
+        for (int it = 1; it < n_threads; it++)
+          m_threads.emplace_back(&ParallelFor::worker, this);
+      }
+
+      ~ParallelFor()
+      {
+        {
+          std::scoped_lock lck(m_mtx);
+          m_stop = true;
+        }
+        m_cv_start.notify_all();
+        for (auto& thread : m_threads)
+          thread.join();
+      }
+
+      ParallelFor(const ParallelFor&) = delete;
+      ParallelFor& operator=(const ParallelFor&) = delete;
+
+      // runs task(idx) for all idx in [0, n_tasks), the first exception thrown by a task is rethrown after all tasks finish
+      void run(const int n_tasks, const std::function<void(int)>& task)
+      {
+        // only one run at a time (the pool may be shared by several copies of the filter)
+        std::scoped_lock run_lck(m_run_mtx);
+        {
+          std::scoped_lock lck(m_mtx);
+          m_task = &task;
+          m_n_tasks = n_tasks;
+          m_next_task = 0;
+          m_n_running = int(m_threads.size());
+          m_exception = nullptr;
+          m_generation++;
+        }
+        m_cv_start.notify_all();
+
+        process_tasks();
+
+        std::unique_lock lck(m_mtx);
+        m_cv_done.wait(lck, [this] { return m_n_running == 0; });
+        m_task = nullptr;
+        if (m_exception)
+          std::rethrow_exception(m_exception);
+      }
+
+    private:
+      std::vector<std::thread> m_threads;
+      std::mutex m_run_mtx;
+      std::mutex m_mtx;
+      std::condition_variable m_cv_start;
+      std::condition_variable m_cv_done;
+
+      const std::function<void(int)>* m_task = nullptr;
+      int m_n_tasks = 0;
+      std::atomic<int> m_next_task = 0;
+      int m_n_running = 0;
+      uint64_t m_generation = 0;
+      bool m_stop = false;
+      std::exception_ptr m_exception;
+
+      void worker()
+      {
+        uint64_t generation = 0;
+        while (true)
+        {
+          {
+            std::unique_lock lck(m_mtx);
+            m_cv_start.wait(lck, [this, generation] { return m_stop || m_generation != generation; });
+            if (m_stop)
+              return;
+            generation = m_generation;
+          }
+
+          process_tasks();
+
+          std::scoped_lock lck(m_mtx);
+          if (--m_n_running == 0)
+            m_cv_done.notify_one();
+        }
+      }
+
+      void process_tasks()
+      {
+        for (int idx = m_next_task++; idx < m_n_tasks; idx = m_next_task++)
+        {
+          try
+          {
+            (*m_task)(idx);
+          }
+          catch (...)
+          {
+            std::scoped_lock lck(m_mtx);
+            if (!m_exception)
+              m_exception = std::current_exception();
+          }
+        }
+      }
+    };
+    //}
+  }  // namespace impl
+}  // namespace mrs_lib
+
+#endif // PARALLEL_FOR_HPP
@@ -11,6 +11,7 @@
 
 #include <ros/ros.h>
 #include <mrs_lib/ukf.h>
+#include <mrs_lib/impl/parallel_for.hpp>
 
 namespace mrs_lib
 {
@@ -89,6 +90,39 @@ namespace mrs_lib
 
     //}
 
+    /* setBatchTransitionModel() method //{ */
+
+    template <int n_states, int n_inputs, int n_measurements>
+    void UKF<n_states, n_inputs, n_measurements>::setBatchTransitionModel(const batch_transition_model_t& transition_model)
+    {
+      m_batch_transition_model = transition_model;
+    }
+
+    //}
+
+    /* setBatchObservationModel() method //{ */
+
+    template <int n_states, int n_inputs, int n_measurements>
+    void UKF<n_states, n_inputs, n_measurements>::setBatchObservationModel(const batch_observation_model_t& observation_model)
+    {
+      m_batch_observation_model = observation_model;
+    }
+
+    //}
+
+  /* setParallelEvaluation() method //{ */
+
+  template <int n_states, int n_inputs, int n_measurements>
+  void UKF<n_states, n_inputs, n_measurements>::setParallelEvaluation(const int n_threads)
+  {
+    if (n_threads > 1)
+      m_thread_pool = std::make_shared<impl::ParallelFor>(n_threads);
+    else
+      m_thread_pool = nullptr;
+  }
+
+  //}
+
   /* computePaSqrt() method //{ */
   template <int n_states, int n_inputs, int n_measurements>
   typename UKF<n_states, n_inputs, n_measurements>::P_t UKF<n_states, n_inputs, n_measurements>::computePaSqrt(const P_t& P) const
@@ -172,6 +206,50 @@ namespace mrs_lib
   }
   //}
 
+  /* transitionSigmas() method //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  typename UKF<n_states, n_inputs, n_measurements>::X_t UKF<n_states, n_inputs, n_measurements>::transitionSigmas(const X_t& S, const u_t& u, const double dt) const
+  {
+    if (m_batch_transition_model)
+      return m_batch_transition_model(S, u, dt);
+
+    X_t X;
+    if (m_thread_pool)
+    {
+      m_thread_pool->run(w, [&](const int i) { X.col(i) = m_transition_model(S.col(i), u, dt); });
+      return X;
+    }
+
+    for (int i = 0; i < w; i++)
+    {
+      X.col(i) = m_transition_model(S.col(i), u, dt);
+    }
+    return X;
+  }
+  //}
+
+  /* observeSigmas() method //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  typename UKF<n_states, n_inputs, n_measurements>::Z_t UKF<n_states, n_inputs, n_measurements>::observeSigmas(const X_t& S, const int z_rows) const
+  {
+    if (m_batch_observation_model)
+      return m_batch_observation_model(S);
+
+    Z_t Z(z_rows, w);
+    if (m_thread_pool)
+    {
+      m_thread_pool->run(w, [&](const int i) { Z.col(i) = m_observation_model(S.col(i)); });
+      return Z;
+    }
+
+    for (int i = 0; i < w; i++)
+    {
+      Z.col(i) = m_observation_model(S.col(i));
+    }
+    return Z;
+  }
+  //}
+
   /* predict() method //{ */
 
   template <int n_states, int n_inputs, int n_measurements>
@@ -184,32 +262,20 @@ namespace mrs_lib
     const X_t S = computeSigmas(x, P);
 
     // propagate sigmas through the transition model
-    X_t X;
-    for (int i = 0; i < w; i++)
-    {
-      X.col(i) = m_transition_model(S.col(i), u, dt);
-    }
+    const X_t X = transitionSigmas(S, u, dt);
 
     /* std::cout << "x: " << std::endl << x << std::endl; */
     /* std::cout << "X rowmean: " << std::endl << X.rowwise().mean() << std::endl; */
     /* std::cout << "m_Wm sum: " << m_Wm.sum() << std::endl; */
 
     // recompute the state vector
-    ret.x = x_t::Zero();
-    for (int i = 0; i < w; i++)
-    {
-      //TODO: WHY DOES THIS SHIT WORK IF I SUBSTITUTE m_Wm(i) FOR 1.0/w ??
-      x_t tmp = 1.0/w * X.col(i);
-      /* x_t tmp = m_Wm(i) * X.col(i); */
-      ret.x += tmp;
-    }
+    //TODO: WHY DOES THIS SHIT WORK IF I SUBSTITUTE m_Wm FOR 1.0/w ??
+    ret.x = X.rowwise().sum() / double(w);
+    /* ret.x = X * m_Wm; */
 
-    // recompute the covariance
-    ret.P = P_t::Zero();
-    for (int i = 0; i < w; i++)
-    {
-      ret.P += m_Wc(i) * (X.col(i) - ret.x) * (X.col(i) - ret.x).transpose();
-    }
+    // recompute the covariance as a single weighted product of the deviations (instead of a sum of w rank-1 updates)
+    const X_t X_dev = X.colwise() - ret.x;
+    ret.P.noalias() = X_dev * m_Wc.asDiagonal() * X_dev.transpose();
     ret.P += Q;
 
     return ret;
@@ -227,33 +293,22 @@ namespace mrs_lib
     const X_t S = computeSigmas(x, P);
 
     // propagate sigmas through the observation model
-    Z_t Z_exp(z.rows(), w);
-    for (int i = 0; i < w; i++)
-    {
-      Z_exp.col(i) = m_observation_model(S.col(i));
-    }
+    const Z_t Z_exp = observeSigmas(S, z.rows());
 
     // compute expected measurement
-    z_t z_exp = z_t::Zero(z.rows());
-    for (int i = 0; i < w; i++)
-    {
-      z_exp += m_Wm(i) * Z_exp.col(i);
-    }
+    const z_t z_exp = Z_exp * m_Wm;
+
+    // the weighted deviations of the measurement sigmas are shared by both of the following products
+    const Z_t Z_dev = Z_exp.colwise() - z_exp;
+    const Z_t Z_dev_w = Z_dev * m_Wc.asDiagonal();
 
     // compute the covariance of measurement
-    Pzz_t Pzz = Pzz_t::Zero(z.rows(), z.rows());
-    for (int i = 0; i < w; i++)
-    {
-      Pzz += m_Wc(i) * (Z_exp.col(i) - z_exp) * (Z_exp.col(i) - z_exp).transpose();
-    }
-    Pzz += R;
+    Pzz_t Pzz = R;
+    Pzz.noalias() += Z_dev_w * Z_dev.transpose();
 
     // compute cross covariance
-    K_t Pxz = K_t::Zero(n, z.rows());
-    for (int i = 0; i < w; i++)
-    {
-      Pxz += m_Wc(i) * (S.col(i) - x) * (Z_exp.col(i) - z_exp).transpose();
-    }
+    K_t Pxz;
+    Pxz.noalias() = (S.colwise() - x) * Z_dev_w.transpose();
 
     // compute Kalman gain
     const z_t inn = (z - z_exp); // innovation
@@ -275,6 +330,187 @@ namespace mrs_lib
 
   //}
 
+  /* sqrtUKF::toSqrt() method //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  typename sqrtUKF<n_states, n_inputs, n_measurements>::sqrt_statecov_t sqrtUKF<n_states, n_inputs, n_measurements>::toSqrt(const statecov_t& sc)
+  {
+    return {sc.x, factorize<n>(sc.P), sc.stamp};
+  }
+  //}
+
+  /* sqrtUKF::fromSqrt() method //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  typename sqrtUKF<n_states, n_inputs, n_measurements>::statecov_t sqrtUKF<n_states, n_inputs, n_measurements>::fromSqrt(const sqrt_statecov_t& sc)
+  {
+    statecov_t ret;
+    ret.x = sc.x;
+    ret.P.noalias() = sc.S * sc.S.transpose();
+    ret.stamp = sc.stamp;
+    return ret;
+  }
+  //}
+
+  /* sqrtUKF::computeSigmas() method //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  typename sqrtUKF<n_states, n_inputs, n_measurements>::X_t sqrtUKF<n_states, n_inputs, n_measurements>::computeSigmas(const x_t& x, const S_t& S) const
+  {
+    // the factor is already known, so it is only scaled (instead of decomposing the covariance as in UKF::computePaSqrt())
+    const S_t Pa_sqrt = std::sqrt(double(n) + this->m_lambda) * S;
+    const auto xrep = x.replicate(1, n);
+
+    X_t ret;
+    ret.col(0) = x;
+    ret.template block<n, n>(0, 1) = xrep + Pa_sqrt;
+    ret.template block<n, n>(0, n + 1) = xrep - Pa_sqrt;
+    return ret;
+  }
+  //}
+
+  /* sqrtUKF::factorize() method //{ */
+  // returns a lower-triangular factor L of a positive semi-definite matrix M, such that M = L*L^T
+  template <int n_states, int n_inputs, int n_measurements>
+  template <int rows>
+  Eigen::Matrix<double, rows, rows> sqrtUKF<n_states, n_inputs, n_measurements>::factorize(const Eigen::Matrix<double, rows, rows>& M)
+  {
+    using M_t = Eigen::Matrix<double, rows, rows>;
+    const Eigen::LLT<M_t> llt(M);
+    if (llt.info() == Eigen::Success)
+      return llt.matrixL();
+    // the Cholesky decomposition fails for singular matrices, so the more robust LDL^T decomposition is used as a fallback
+    const Eigen::LDLT<M_t> ldlt(M);
+    if (ldlt.info() != Eigen::Success)
+      throw square_root_exception();
+    M_t L = ldlt.matrixL();
+    L = ldlt.transpositionsP().transpose() * (L * ldlt.vectorD().cwiseMax(0.0).cwiseSqrt().asDiagonal());
+    return L;
+  }
+  //}
+
+  /* sqrtUKF::qrFactor() method //{ */
+  // returns a lower-triangular factor L, such that L*L^T = A*A^T, using the QR decomposition of A^T
+  template <int n_states, int n_inputs, int n_measurements>
+  template <int rows, int cols>
+  Eigen::Matrix<double, rows, rows> sqrtUKF<n_states, n_inputs, n_measurements>::qrFactor(const Eigen::Matrix<double, rows, cols>& A)
+  {
+    using At_t = Eigen::Matrix<double, cols, rows>;
+    const Eigen::HouseholderQR<At_t> qr(A.transpose());
+    Eigen::Matrix<double, rows, rows> L = qr.matrixQR().template topRows<rows>().template triangularView<Eigen::Upper>().transpose();
+    // make the diagonal positive (flipping the sign of a column does not change L*L^T), which is required by cholUpdate()
+    for (int it = 0; it < rows; it++)
+      if (L(it, it) < 0.0)
+        L.col(it) = -L.col(it);
+    return L;
+  }
+  //}
+
+  /* sqrtUKF::cholUpdate() method //{ */
+  // updates the lower-triangular factor L in place, so that L*L^T becomes L*L^T + sigma*v*v^T (a downdate for a negative sigma)
+  template <int n_states, int n_inputs, int n_measurements>
+  template <int rows>
+  void sqrtUKF<n_states, n_inputs, n_measurements>::cholUpdate(Eigen::Matrix<double, rows, rows>& L, Eigen::Matrix<double, rows, 1> v, const double sigma)
+  {
+    for (int k = 0; k < rows; k++)
+    {
+      const double L_kk = L(k, k);
+      const double r_sq = L_kk * L_kk + sigma * v(k) * v(k);
+      if (!(r_sq > 0.0) || !(L_kk > 0.0))
+      {
+        ROS_WARN("UKF: rank-1 update of the covariance factor failed - the covariance is not positive definite.");
+        throw square_root_exception();
+      }
+      const double r = std::sqrt(r_sq);
+      const double c = r / L_kk;
+      const double s = v(k) / L_kk;
+      L(k, k) = r;
+      const int rest = rows - k - 1;
+      if (rest > 0)
+      {
+        L.col(k).tail(rest) = (L.col(k).tail(rest) + sigma * s * v.tail(rest)) / c;
+        v.tail(rest) = c * v.tail(rest) - s * L.col(k).tail(rest);
+      }
+    }
+  }
+  //}
+
+  /* sqrtUKF::predict() method //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  typename sqrtUKF<n_states, n_inputs, n_measurements>::sqrt_statecov_t sqrtUKF<n_states, n_inputs, n_measurements>::predict(const sqrt_statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const
+  {
+    const X_t S = computeSigmas(sc.x, sc.S);
+
+    // propagate sigmas through the transition model
+    const X_t X = this->transitionSigmas(S, u, dt);
+
+    sqrt_statecov_t ret;
+    ret.stamp = sc.stamp;
+    // recompute the state vector (the same as in UKF::predict())
+    ret.x = X.rowwise().sum() / double(w);
+
+    // the factor of the covariance from the weighted deviations of the sigma points (except for the first one) and the factor of Q
+    Eigen::Matrix<double, n, 3 * n> A;
+    A.template leftCols<2 * n>() = std::sqrt(this->m_Wc(1)) * (X.template rightCols<2 * n>().colwise() - ret.x);
+    A.template rightCols<n>() = factorize<n>(Q);
+    ret.S = qrFactor<n, 3 * n>(A);
+
+    // the first weight may be negative, which results in a downdate
+    const double Wc0 = this->m_Wc(0);
+    cholUpdate<n>(ret.S, std::sqrt(std::abs(Wc0)) * (X.col(0) - ret.x), Wc0 < 0.0 ? -1.0 : 1.0);
+    return ret;
+  }
+  //}
+
+  /* sqrtUKF::correct() method //{ */
+  template <int n_states, int n_inputs, int n_measurements>
+  typename sqrtUKF<n_states, n_inputs, n_measurements>::sqrt_statecov_t sqrtUKF<n_states, n_inputs, n_measurements>::correct(const sqrt_statecov_t& sc, const z_t& z, const R_t& R) const
+  {
+    const X_t S = computeSigmas(sc.x, sc.S);
+
+    // propagate sigmas through the observation model
+    const Z_t Z_exp = this->observeSigmas(S, z.rows());
+
+    // compute expected measurement
+    const z_t z_exp = Z_exp * this->m_Wm;
+
+    // the factor of the covariance of measurement (the same way as in predict())
+    const Eigen::LLT<R_t> llt(R);
+    if (llt.info() != Eigen::Success)
+    {
+      ROS_ERROR("UKF: the measurement covariance is not positive definite!!! Fix your covariances.");
+      throw inverse_exception();
+    }
+    Eigen::Matrix<double, p, 2 * n + p> A;
+    A.template leftCols<2 * n>() = std::sqrt(this->m_Wc(1)) * (Z_exp.template rightCols<2 * n>().colwise() - z_exp);
+    A.template rightCols<p>() = llt.matrixL();
+    Pzz_t Sz = qrFactor<p, 2 * n + p>(A);
+    const double Wc0 = this->m_Wc(0);
+    cholUpdate<p>(Sz, std::sqrt(std::abs(Wc0)) * (Z_exp.col(0) - z_exp), Wc0 < 0.0 ? -1.0 : 1.0);
+
+    // compute cross covariance
+    K_t Pxz;
+    Pxz.noalias() = (S.colwise() - sc.x) * this->m_Wc.asDiagonal() * (Z_exp.colwise() - z_exp).transpose();
+
+    // compute Kalman gain K = Pxz*(Sz*Sz^T)^-1 using two triangular solves
+    const K_t K = Sz.transpose().template triangularView<Eigen::Upper>().solve(Sz.template triangularView<Eigen::Lower>().solve(Pxz.transpose())).transpose();
+
+    // check whether the solution produced valid numbers
+    if (!K.array().isFinite().all())
+    {
+      ROS_ERROR("UKF: solving for the Kalman gain in correction update produced non-finite numbers!!! Fix your covariances (the measurement's is probably too low...)");
+      throw inverse_exception();
+    }
+
+    // correct - the covariance is downdated by the columns of U = K*Sz (because K*Pzz*K^T = U*U^T)
+    sqrt_statecov_t ret;
+    ret.stamp = sc.stamp;
+    ret.x = sc.x + K * (z - z_exp);
+    ret.S = sc.S;
+    const K_t U = K * Sz;
+    for (int it = 0; it < p; it++)
+      cholUpdate<n>(ret.S, U.col(it), -1.0);
+    return ret;
+  }
+  //}
+
 }  // namespace mrs_lib
 
 #endif
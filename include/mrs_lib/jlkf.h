@@ -9,6 +9,7 @@
 #include <mrs_lib/kalman_filter_aloamgarm.h>
 /* #include <mrs_lib/lkf.h> */
 #include <iostream>
+#include <cmath>
 
 #include <vector>
 
@@ -143,10 +144,29 @@ namespace mrs_lib
     virtual statecov_t correct(const statecov_t& sc, const z_t& z, const R_t& R) const override
     {
       /* return correct_optimized(sc, z, R, H); */
+      if (m_sequential_correction && R.isDiagonal(0.0))
+        return correction_sequential_impl(sc, z, R.diagonal(), H);
       return correction_impl(sc, z, R, H);
     };
     //}
 
+    /* setSequentialCorrection() method //{ */
+    /*!
+     * \brief Enables or disables the sequential correction for diagonal measurement noise covariance matrices.
+     *
+     * If enabled, the correct() method checks whether \p R is diagonal and if so, the measurement is applied as \f$ p \f$ independent
+     * scalar measurements one after another instead of inverting the \f$ p \times p \f$ innovation covariance matrix. The NIS is
+     * accumulated from the scalar innovations and the jump detection works the same as with the standard correction.
+     * It is disabled by default.
+     *
+     * \param enable      Whether the sequential correction should be used for diagonal measurement noise covariance matrices.
+     */
+    void setSequentialCorrection(const bool enable)
+    {
+      m_sequential_correction = enable;
+    };
+    //}
+
   protected:
     /* invert_W() method //{ */
     static R_t invert_W(R_t W)
@@ -170,22 +190,58 @@ namespace mrs_lib
     //}
 
 
+    /* factorize_W() method //{ */
+    // the same as invert_W(), but returns the decomposition, so that it can be reused for multiple solutions without inverting W
+    static Eigen::ColPivHouseholderQR<R_t> factorize_W(R_t W)
+    {
+      Eigen::ColPivHouseholderQR<R_t> qr(W);
+      if (!qr.isInvertible())
+      {
+        // add some stuff to the tmp matrix diagonal to make it invertible
+        R_t ident = R_t::Identity(W.rows(), W.cols());
+        W += 1e-9 * ident;
+        qr.compute(W);
+        if (!qr.isInvertible())
+        {
+          // never managed to make this happen except for explicitly putting NaNs in the input
+          throw inverse_exception();
+        }
+      }
+      return qr;
+    }
+    //}
+
     /* computeKalmanGain() method //{ */
     virtual K_t computeKalmanGain(const statecov_t& sc, [[maybe_unused]] const z_t& z, const R_t& R, const H_t& H, double& nis, H_t& H_out,
-                                  const double& nis_thr, const double& nis_avg_thr) const
+                                  const double& nis_thr, [[maybe_unused]] const double& nis_avg_thr) const
     {
       H_out = H;
 
-      R_t W = H * sc.P * H.transpose() + R;
-      R_t W_inv = invert_W(W);
-      K_t K = sc.P * H.transpose() * W_inv;
-      z_t y = z - (H * sc.x);
+      const R_t W = H * sc.P * H.transpose() + R;
+      // the decomposition of W is shared by the Kalman gain and the NIS
+      const auto W_qr = factorize_W(W);
+      // K = P*H^T*W^-1, W is symmetric, so K^T = W^-1*H*P
+      const Eigen::Matrix<double, p, n> HP = H * sc.P;
+      K_t K = W_qr.solve(HP).transpose();
+      const z_t y = z - (H * sc.x);
+
+      nis = y.dot(W_qr.solve(y));
+
+      if (evaluateNis(sc, nis, H, nis_thr))
+      {
+        // old jump correction
+        K = computeBiasOnlyGain(H, H_out);
+      }
+
+      return K;
+    }
+    //}
 
-      /* const double nis = (y.transpose() * W_inv * y)(0, 0); */
-      nis = (y.transpose() * W_inv * y)(0, 0);
-      double nis_avg = 0;
-      int count = 0;
-      bool nis_over_thr = false;
+    /* evaluateNis() method //{ */
+    // updates the NIS buffer and publishes the debug message, returns true if a jump in the measurement was detected
+    bool evaluateNis(const statecov_t& sc, const double nis, const H_t& H, const double& nis_thr) const
+    {
+      bool jumped = false;
 
       double nis_thr_tmp = nis_thr;
 
@@ -199,44 +255,82 @@ namespace mrs_lib
 
         if (sc.nis_buffer != nullptr)
         {
-
           sc.nis_buffer->push_back(nis);
-          for (auto it = sc.nis_buffer->begin(); it != sc.nis_buffer->end(); it++)
+          // the threshold is lowered by each value in the window, which exceeds the current threshold, going from the oldest one,
+          // which is only possible if the maximum exceeds the original threshold - the window has to be traversed only around jumps
+          if (sc.nis_buffer->max() > nis_thr_tmp)
           {
-            nis_avg += *it;
-            count++;
-            if (*it > nis_thr_tmp)
+            for (const double val : *sc.nis_buffer)
             {
-              nis_thr_tmp /= 10;
+              if (val > nis_thr_tmp)
+              {
+                nis_thr_tmp /= 10;
+              }
             }
           }
-          if (count > 0)
-          {
-            nis_avg /= count;
-          }
-          msg.values.push_back(nis_avg);
+          msg.values.push_back(sc.nis_buffer->mean());
           msg.values.push_back(nis_thr_tmp);
         }
-        if (nis > nis_thr_tmp)
-        {
-          // old jump correction
-          K = K.Zero();
-          A_t mask = mask.Zero();
-          for (int i = n_states - n_biases; i < n_states; i++)
-          {
-            mask(i, i) = 1;
-          }
-          const H_t H_bias_only = H * mask;
-          K = H_bias_only.transpose() * invert_W(H_bias_only * H_bias_only.transpose());
-          H_out = H_bias_only;
-        }
+        jumped = nis > nis_thr_tmp;
 
         debug_nis_pub.publish(msg);
       }
 
-      K_t test = H.transpose() * invert_W(H * H.transpose());
+      return jumped;
+    }
+    //}
 
-      return K;
+    /* computeBiasOnlyGain() method //{ */
+    // the Kalman gain, which only corrects the bias states (used when a jump in the measurement is detected)
+    static K_t computeBiasOnlyGain(const H_t& H, H_t& H_out)
+    {
+      A_t mask = mask.Zero();
+      for (int i = n_states - n_biases; i < n_states; i++)
+      {
+        mask(i, i) = 1;
+      }
+      const H_t H_bias_only = H * mask;
+      H_out = H_bias_only;
+      return H_bias_only.transpose() * invert_W(H_bias_only * H_bias_only.transpose());
+    }
+    //}
+
+    /* correction_sequential_impl() method //{ */
+    // applies the measurement as independent scalar measurements (R = diag(R_diag)) unless a jump is detected
+    statecov_t correction_sequential_impl(const statecov_t& sc, const z_t& z, const z_t& R_diag, const H_t& H) const
+    {
+      statecov_t ret;
+      ret.x = sc.x;
+      ret.P = sc.P;
+      double nis = 0.0;
+      for (int it = 0; it < z.rows(); it++)
+      {
+        const auto h = H.row(it);
+        const x_t Ph = ret.P * h.transpose();
+        double s = h.dot(Ph) + R_diag(it);
+        // same as in invert_W() - add a small number to make the variance invertible
+        if (!(s > 0.0))
+          s += 1e-9;
+        if (!(s > 0.0) || !std::isfinite(s))
+          throw inverse_exception();
+        const double inn = z(it) - h.dot(ret.x);
+        const x_t K = Ph / s;
+        ret.x += K * inn;
+        ret.P.noalias() -= K * Ph.transpose();
+        nis += inn * inn / s;
+      }
+
+      // the sum of the normalized squares of the sequential innovations is equal to the NIS of the whole measurement
+      if (evaluateNis(sc, nis, H, m_nis_thr))
+      {
+        // old jump correction
+        H_t H_out;
+        const K_t K = computeBiasOnlyGain(H, H_out);
+        ret.x = sc.x + K * (z - (H * sc.x));
+        ret.P = (P_t::Identity(sc.P.rows(), sc.P.cols()) - (K * H_out)) * sc.P;
+      }
+      ret.nis_buffer = sc.nis_buffer;
+      return ret;
     }
     //}
 
@@ -273,9 +367,9 @@ namespace mrs_lib
   private:
     ros::NodeHandle m_nh;
     ros::Publisher debug_nis_pub;
-    std::vector<double> m_nis_window;
     double m_nis_thr;
     double m_nis_avg_thr;
+    bool m_sequential_correction = false;
 
 
   private:
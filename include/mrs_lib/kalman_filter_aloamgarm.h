@@ -14,6 +14,92 @@
 
 namespace mrs_lib
 {
+  /* NisBuffer class //{ */
+  /**
+  * \brief A sliding window of NIS (normalized innovation squared) values with incrementally updated statistics.
+  *
+  * The mean and the maximum of the values in the window are updated with each new value in amortized constant time
+  * (the mean using a running sum and the maximum using a monotonic queue of the candidates), so the statistics
+  * don't have to be recomputed by iterating over the whole window after each correction.
+  */
+  class NisBuffer
+  {
+    public:
+    /*!
+      * \brief The main constructor.
+      *
+      * \param capacity    Length of the sliding window.
+      */
+      NisBuffer(const size_t capacity) : m_values(capacity), m_max_candidates(capacity) {};
+
+    /*!
+      * \brief Adds a new value to the window, removing the oldest one if the window is full.
+      *
+      * \param nis         The new value.
+      */
+      void push_back(const double nis)
+      {
+        if (m_values.capacity() == 0)
+          return;
+
+        if (m_values.full())
+        {
+          const double oldest = m_values.front();
+          m_sum -= oldest;
+          if (m_max_candidates.front() == oldest)
+            m_max_candidates.pop_front();
+        }
+        m_values.push_back(nis);
+
+        // the running sum would slowly accumulate rounding errors, so it is recalculated once per each pass through the window
+        if (++m_n_pushes >= m_values.capacity())
+        {
+          m_n_pushes = 0;
+          m_sum = 0.0;
+          for (const double val : m_values)
+            m_sum += val;
+        }
+        else
+        {
+          m_sum += nis;
+        }
+
+        // values older and lower than the new one can never be the maximum again
+        while (!m_max_candidates.empty() && m_max_candidates.back() < nis)
+          m_max_candidates.pop_back();
+        m_max_candidates.push_back(nis);
+      }
+
+    /*!
+      * \brief Returns the mean of the values in the window (zero if the window is empty).
+      */
+      double mean() const
+      {
+        return m_values.empty() ? 0.0 : m_sum / m_values.size();
+      }
+
+    /*!
+      * \brief Returns the maximal value in the window (zero if the window is empty).
+      */
+      double max() const
+      {
+        return m_max_candidates.empty() ? 0.0 : m_max_candidates.front();
+      }
+
+      size_t size() const { return m_values.size(); }         /*!< \brief Returns the number of values in the window. */
+      size_t capacity() const { return m_values.capacity(); } /*!< \brief Returns the length of the window. */
+      bool empty() const { return m_values.empty(); }         /*!< \brief Returns true if there are no values in the window. */
+      auto begin() const { return m_values.begin(); }         /*!< \brief Returns an iterator to the oldest value in the window. */
+      auto end() const { return m_values.end(); }             /*!< \brief Returns an iterator past the newest value in the window. */
+
+    private:
+      boost::circular_buffer<double> m_values;
+      boost::circular_buffer<double> m_max_candidates; // non-increasing values from the window
+      double m_sum = 0.0;
+      size_t m_n_pushes = 0;
+  };
+  //}
+
   /* KalmanFilter virtual class //{ */
   /**
   * \brief This abstract class defines common interfaces and types for a generic Kalman filter.
@@ -49,7 +135,7 @@ namespace mrs_lib
       {
         x_t x;  /*!< \brief State vector. */
         P_t P;  /*!< \brief State covariance matrix. */
-        std::shared_ptr<boost::circular_buffer<double>> nis_buffer = nullptr;
+        std::shared_ptr<NisBuffer> nis_buffer = nullptr; /*!< \brief Sliding window of the NIS values (used for jump detection). */
         ros::Time stamp = ros::Time(0);
         bool measurement_jumped = false;
 
@@ -61,7 +147,7 @@ namespace mrs_lib
             P = other.P;
             stamp = other.stamp;
             if (other.nis_buffer != nullptr){
-              nis_buffer = std::make_shared<boost::circular_buffer<double>>(*other.nis_buffer);
+              nis_buffer = std::make_shared<NisBuffer>(*other.nis_buffer);
             }
             measurement_jumped = other.measurement_jumped;
           }
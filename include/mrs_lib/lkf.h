@@ -8,6 +8,12 @@
 
 #include <mrs_lib/kalman_filter.h>
 #include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
 
 namespace mrs_lib
 {
@@ -111,10 +117,47 @@ namespace mrs_lib
     virtual statecov_t correct(const statecov_t& sc, const z_t& z, const R_t& R) const override
     {
       /* return correct_optimized(sc, z, R, H); */
+      if (m_sequential_correction && R.isDiagonal(0.0))
+        return correction_sequential_impl(sc, z, R.diagonal(), H);
       return correction_impl(sc, z, R, H);
     };
     //}
 
+    /* correctDiagonal() method //{ */
+  /*!
+    * \brief Applies the correction step of the Kalman filter with a diagonal measurement noise covariance matrix.
+    *
+    * The measurement is applied as \f$ p \f$ independent scalar measurements one after another (see setSequentialCorrection()),
+    * which doesn't require any matrix inversion. The result is the same as of the correct() method with \p R having
+    * the elements of \p R_diag on its diagonal.
+    *
+    * \param sc          The state and covariance to which the correction step is to be applied.
+    * \param z           The measurement vector to be used for correction.
+    * \param R_diag      Diagonal of the measurement noise covariance matrix (the variances of the individual measurements).
+    * \return            The state and covariance after the correction update.
+    */
+    statecov_t correctDiagonal(const statecov_t& sc, const z_t& z, const z_t& R_diag) const
+    {
+      return correction_sequential_impl(sc, z, R_diag, H);
+    };
+    //}
+
+    /* setSequentialCorrection() method //{ */
+  /*!
+    * \brief Enables or disables the sequential correction for diagonal measurement noise covariance matrices.
+    *
+    * If enabled, the correct() method checks whether \p R is diagonal and if so, the measurement is applied as \f$ p \f$ independent
+    * scalar measurements one after another instead of inverting the \f$ p \times p \f$ innovation covariance matrix. This is cheaper,
+    * especially for larger \f$ p \f$, and gives the same results. It is disabled by default.
+    *
+    * \param enable      Whether the sequential correction should be used for diagonal measurement noise covariance matrices.
+    */
+    void setSequentialCorrection(const bool enable)
+    {
+      m_sequential_correction = enable;
+    };
+    //}
+
     /* predict() method //{ */
   /*!
     * \brief Applies the prediction (time) step of the Kalman filter.
@@ -144,11 +187,29 @@ namespace mrs_lib
     };
     //}
 
+    /* getA() method //{ */
+  /*!
+    * \brief Returns the state transition matrix, which is used for the prediction step by \p dt.
+    *
+    * This is used eg. by the Repredictor for smoothing of the state history.
+    *
+    * \param dt          The time step of the prediction.
+    * \return            The state transition matrix.
+    */
+    virtual A_t getA([[maybe_unused]] double dt) const
+    {
+      return A;
+    };
+    //}
+
   public:
     A_t A;  /*!< \brief The system transition matrix \f$n \times n\f$ */
     B_t B;  /*!< \brief The input to state mapping matrix \f$n \times m\f$ */
     H_t H;  /*!< \brief The state to measurement mapping matrix \f$p \times n\f$ */
 
+  protected:
+    bool m_sequential_correction = false;
+
   protected:
     /* covariance_predict() method //{ */
     static P_t covariance_predict(const A_t& A, const P_t& P, const Q_t& Q, const double dt)
@@ -229,6 +290,41 @@ namespace mrs_lib
     }
     //}
 
+    /* correction_sequential() method //{ */
+    // applies the measurement as independent scalar measurements (R = diag(R_diag)), the normalized innovation squared is returned in nis
+    static statecov_t correction_sequential(const statecov_t& sc, const z_t& z, const z_t& R_diag, const H_t& H, double& nis)
+    {
+      statecov_t ret = sc;
+      nis = 0.0;
+      for (int it = 0; it < z.rows(); it++)
+      {
+        const auto h = H.row(it);
+        const x_t Ph = ret.P * h.transpose();
+        double s = h.dot(Ph) + R_diag(it);
+        // same as in invert_W() - add a small number to make the variance invertible
+        if (!(s > 0.0))
+          s += 1e-9;
+        if (!(s > 0.0) || !std::isfinite(s))
+          throw inverse_exception();
+        const double inn = z(it) - h.dot(ret.x);
+        const x_t K = Ph / s;
+        ret.x += K * inn;
+        ret.P.noalias() -= K * Ph.transpose();
+        nis += inn * inn / s;
+      }
+      return ret;
+    }
+    //}
+
+    /* correction_sequential_impl() method //{ */
+    // the sequential correction, used for diagonal measurement noise covariance matrices (derived classes modifying the Kalman gain should override this)
+    virtual statecov_t correction_sequential_impl(const statecov_t& sc, const z_t& z, const z_t& R_diag, const H_t& H) const
+    {
+      double nis;
+      return correction_sequential(sc, z, R_diag, H, nis);
+    }
+    //}
+
     // NOT USED METHODS
     /* correction_optimized() method //{ */
     // No notable performance gain was observed for the matrix sizes we use, so this is not used.
@@ -256,6 +352,18 @@ namespace mrs_lib
   //}
 
   /* class dtMatrixLKF //{ */
+  /**
+  * \brief Variant of the LKF with the system matrices generated based on the time step of the prediction.
+  *
+  * The matrices are generated using user-supplied functions, or using a polynomial model (see polynomial_model_t), which is
+  * evaluated in a closed form. If the generating functions are expensive (eg. they compute a matrix exponential) and
+  * the time steps repeat (eg. they are quantized), the generated matrices may be cached (see setCache()).
+  *
+  * \tparam n_states         number of states of the system (length of the \f$ \mathbf{x} \f$ vector).
+  * \tparam n_inputs         number of inputs of the system (length of the \f$ \mathbf{u} \f$ vector).
+  * \tparam n_measurements   number of measurements of the system (length of the \f$ \mathbf{z} \f$ vector).
+  *
+  */
   template <int n_states, int n_inputs, int n_measurements>
   class varstepLKF : public LKF<n_states, n_inputs, n_measurements>
   {
@@ -279,6 +387,34 @@ namespace mrs_lib
 
     using generateA_t = std::function<A_t(double)>;
     using generateB_t = std::function<B_t(double)>;
+
+    using coeff_A_t = A_t;                            // matrix of constant coefficients in matrix A
+    typedef Eigen::Matrix<unsigned, n, n> dtexp_A_t;  // matrix of dt exponents in matrix A
+    using coeff_B_t = B_t;                            // matrix of constant coefficients in matrix B
+    typedef Eigen::Matrix<unsigned, n, m> dtexp_B_t;  // matrix of dt exponents in matrix B
+
+  /*!
+    * \brief Helper struct describing system matrices, whose elements are polynomials of the time step.
+    *
+    * Element \f$ (i, j) \f$ of the matrix \f$ \mathbf{A}(dt) \f$ is \f$ c_{ij} dt^{e_{ij}} \f$, where \f$ c_{ij} \f$
+    * is the corresponding element of #coeff_A and \f$ e_{ij} \f$ of #dtexp_A (and the same for \f$ \mathbf{B}(dt) \f$).
+    */
+    struct polynomial_model_t
+    {
+      coeff_A_t coeff_A = coeff_A_t::Zero();  /*!< \brief Constant coefficients of the elements of the matrix \f$ \mathbf{A} \f$. */
+      dtexp_A_t dtexp_A = dtexp_A_t::Zero();  /*!< \brief Exponents of the time step in the elements of the matrix \f$ \mathbf{A} \f$. */
+      coeff_B_t coeff_B = coeff_B_t::Zero();  /*!< \brief Constant coefficients of the elements of the matrix \f$ \mathbf{B} \f$. */
+      dtexp_B_t dtexp_B = dtexp_B_t::Zero();  /*!< \brief Exponents of the time step in the elements of the matrix \f$ \mathbf{B} \f$. */
+    };
+
+  /*!
+    * \brief Helper struct with the statistics of the cache of the generated matrices, returned by the getCacheStatistics() method.
+    */
+    struct cache_statistics_t
+    {
+      uint64_t n_hits = 0;    /*!< \brief Number of time steps, for which the matrices were found in the cache. */
+      uint64_t n_misses = 0;  /*!< \brief Number of time steps, for which the matrices had to be generated. */
+    };
     //}
 
   public:
@@ -296,6 +432,101 @@ namespace mrs_lib
       Base_class::H = H;
     };
 
+  /*!
+    * \brief Constructor for system matrices, whose elements are polynomials of the time step.
+    *
+    * The matrices are evaluated in a closed form, which is cheaper than calling general generating functions.
+    * See also the integratorModel() method.
+    *
+    * \param model     the coefficients and exponents of the system matrices.
+    * \param H         the state to measurement mapping matrix.
+    */
+    varstepLKF(const polynomial_model_t& model, const H_t& H)
+      : m_generateA(polynomialGenerator(model.coeff_A, model.dtexp_A)), m_generateB(polynomialGenerator(model.coeff_B, model.dtexp_B))
+    {
+      Base_class::H = H;
+    };
+
+    /* integratorModel() method //{ */
+  /*!
+    * \brief Returns the polynomial model of a chain of integrators (eg. the constant acceleration model for \p n_derivatives = 3).
+    *
+    * The states are ordered by the derivatives - first the positions in all \f$ n/n_{der} \f$ axes, then the velocities etc.
+    * The highest derivative is constant during the prediction. The input matrix \f$ \mathbf{B} \f$ is zero and may be set
+    * in the returned struct according to the specific system.
+    *
+    * \param n_derivatives   number of the derivatives of the position in the state including the position itself (must divide \f$ n \f$).
+    * \return                the polynomial model of the system.
+    */
+    static polynomial_model_t integratorModel(const int n_derivatives = 3)
+    {
+      assert(n_derivatives > 0 && n % n_derivatives == 0);
+      const int n_axes = n / n_derivatives;
+      polynomial_model_t ret;
+      for (int row = 0; row < n_derivatives; row++)
+      {
+        double factorial = 1.0;
+        for (int col = row; col < n_derivatives; col++)
+        {
+          if (col > row)
+            factorial *= col - row;
+          for (int axis = 0; axis < n_axes; axis++)
+          {
+            ret.coeff_A(row * n_axes + axis, col * n_axes + axis) = 1.0 / factorial;
+            ret.dtexp_A(row * n_axes + axis, col * n_axes + axis) = col - row;
+          }
+        }
+      }
+      return ret;
+    }
+    //}
+
+    /* setCache() method //{ */
+  /*!
+    * \brief Enables or disables caching of the generated system matrices.
+    *
+    * When enabled, the last \p max_size different generated pairs of the matrices \f$ \mathbf{A} \f$ and \f$ \mathbf{B} \f$ are kept
+    * together with the time step \f$ dt \f$, for which they were generated. If the time step of a following prediction differs
+    * at most by \p dt_tolerance, the cached matrices are used instead of generating new ones. The cache is searched linearly,
+    * so \p max_size should be small (a few tens at most). Caching is disabled by default. Calling this method clears the cache.
+    *
+    * \param dt_tolerance    the largest difference of two time steps, for which the same matrices are used (zero for exact matching).
+    * \param max_size        the largest number of cached matrix pairs (zero disables the caching).
+    *
+    * \note The predict() and getA() methods modify the cache, so they must not be called concurrently when the caching is enabled.
+    */
+    void setCache(const double dt_tolerance, const size_t max_size)
+    {
+      m_cache_dt_tolerance = dt_tolerance;
+      m_cache_max_size = max_size;
+      m_cache.clear();
+      m_cache.reserve(max_size);
+      m_cache_next = 0;
+    };
+    //}
+
+    /* getCacheStatistics() method //{ */
+  /*!
+    * \brief Returns the numbers of cache hits and misses since the construction or since the last call of resetCacheStatistics().
+    *
+    * \return            The statistics of the cache.
+    */
+    cache_statistics_t getCacheStatistics() const
+    {
+      return m_cache_stats;
+    };
+    //}
+
+    /* resetCacheStatistics() method //{ */
+  /*!
+    * \brief Resets the numbers of cache hits and misses to zero.
+    */
+    void resetCacheStatistics()
+    {
+      m_cache_stats = {};
+    };
+    //}
+
     /* predict() method //{ */
   /*!
     * \brief Applies the prediction (time) step of the Kalman filter.
@@ -316,6 +547,13 @@ namespace mrs_lib
     virtual statecov_t predict(const statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const override
     {
       statecov_t ret;
+      if (m_cache_max_size > 0)
+      {
+        const cache_entry_t& entry = cached(dt);
+        ret.x = Base_class::state_predict(entry.A, sc.x, entry.B, u);
+        ret.P = Base_class::covariance_predict(entry.A, sc.P, Q, dt);
+        return ret;
+      }
       A_t A = m_generateA(dt);
       B_t B = m_generateB(dt);
       ret.x = Base_class::state_predict(A, sc.x, B, u);
@@ -323,10 +561,320 @@ namespace mrs_lib
       return ret;
     };
     //}
+
+    /* getA() method //{ */
+  /*!
+    * \brief Returns the state transition matrix, which is used for the prediction step by \p dt.
+    *
+    * \param dt          The time step of the prediction, passed to the function generating the matrix.
+    * \return            The state transition matrix.
+    */
+    virtual A_t getA(double dt) const override
+    {
+      if (m_cache_max_size > 0)
+        return cached(dt).A;
+      return m_generateA(dt);
+    };
+    //}
     
+  private:
+    struct cache_entry_t
+    {
+      double dt;
+      A_t A;
+      B_t B;
+    };
+
   private:
     generateA_t m_generateA;
     generateB_t m_generateB;
+
+    double m_cache_dt_tolerance = 0.0;
+    size_t m_cache_max_size = 0;
+    mutable std::vector<cache_entry_t> m_cache;
+    mutable size_t m_cache_next = 0;  // index of the entry to be replaced when the cache is full
+    mutable cache_statistics_t m_cache_stats;
+
+  private:
+    /* cached() method //{ */
+    // returns the cached matrices for the time step dt, generating and caching them if they are not in the cache yet
+    const cache_entry_t& cached(const double dt) const
+    {
+      for (const auto& entry : m_cache)
+      {
+        if (std::abs(entry.dt - dt) <= m_cache_dt_tolerance)
+        {
+          m_cache_stats.n_hits++;
+          return entry;
+        }
+      }
+
+      m_cache_stats.n_misses++;
+      cache_entry_t entry{dt, m_generateA(dt), m_generateB(dt)};
+      if (m_cache.size() < m_cache_max_size)
+      {
+        m_cache.push_back(std::move(entry));
+        return m_cache.back();
+      }
+      // the cache is full - replace the oldest entry
+      const size_t idx = m_cache_next;
+      m_cache_next = (m_cache_next + 1) % m_cache_max_size;
+      m_cache.at(idx) = std::move(entry);
+      return m_cache.at(idx);
+    }
+    //}
+
+    /* polynomialGenerator() method //{ */
+    // returns a function evaluating a matrix with elements coeff(i, j)*dt^dtexp(i, j)
+    template <typename coeff_t, typename dtexp_t>
+    static std::function<coeff_t(double)> polynomialGenerator(const coeff_t& coeff, const dtexp_t& dtexp)
+    {
+      return [coeff, dtexp](const double dt)
+      {
+        coeff_t ret = coeff;
+        for (int row = 0; row < ret.rows(); row++)
+          for (int col = 0; col < ret.cols(); col++)
+            if (ret(row, col) != 0.0)
+              for (unsigned it = 0; it < dtexp(row, col); it++)
+                ret(row, col) *= dt;
+        return ret;
+      };
+    }
+    //}
+  };
+  //}
+
+  /* class sqrtLKF //{ */
+  /**
+  * \brief Implementation of the square-root form of the Linear Kalman filter \cite SRKF.
+  *
+  * Instead of the state covariance matrix \f$ \mathbf{P} \f$, the square-root filter works with its factor \f$ \mathbf{S} \f$,
+  * such that \f$ \mathbf{P} = \mathbf{S}\mathbf{S}^\intercal \f$ (see the sqrt_statecov_t struct). The measurement is first
+  * decorrelated using the Cholesky factor of its covariance matrix and the individual (now independent) scalar measurements are
+  * then applied using the Potter's algorithm as rank-1 downdates of the factor. This costs \f$ O(pn^2) \f$ operations per correction
+  * (compared to \f$ O(n^3) \f$ of the LKF), no matrix has to be inverted, and the resulting covariance matrix is positive
+  * semi-definite by construction. The prediction step computes the new factor using the QR decomposition.
+  *
+  * The correct() and predict() methods, working with the sqrt_statecov_t struct, should be used in performance-critical code,
+  * so that the factor doesn't have to be recalculated. The methods working with the statecov_t struct, required by the KalmanFilter
+  * interface, are also implemented (so that this class may be used eg. with the Repredictor), but they compute the factor from
+  * the covariance matrix (and vice versa) on each call.
+  *
+  * \tparam n_states         number of states of the system (length of the \f$ \mathbf{x} \f$ vector).
+  * \tparam n_inputs         number of inputs of the system (length of the \f$ \mathbf{u} \f$ vector).
+  * \tparam n_measurements   number of measurements of the system (length of the \f$ \mathbf{z} \f$ vector).
+  *
+  */
+  template <int n_states, int n_inputs, int n_measurements>
+  class sqrtLKF : public LKF<n_states, n_inputs, n_measurements>
+  {
+  public:
+    /* sqrtLKF definitions (typedefs, constants etc) //{ */
+    static constexpr int n = n_states;                   /*!< \brief Length of the state vector of the system. */
+    static constexpr int m = n_inputs;                   /*!< \brief Length of the input vector of the system. */
+    static constexpr int p = n_measurements;             /*!< \brief Length of the measurement vector of the system. */
+    using Base_class = LKF<n, m, p>;                     /*!< \brief Base class of this class. */
+
+    using x_t = typename Base_class::x_t;                /*!< \brief State vector type \f$n \times 1\f$ */
+    using u_t = typename Base_class::u_t;                /*!< \brief Input vector type \f$m \times 1\f$ */
+    using z_t = typename Base_class::z_t;                /*!< \brief Measurement vector type \f$p \times 1\f$ */
+    using P_t = typename Base_class::P_t;                /*!< \brief State uncertainty covariance matrix type \f$n \times n\f$ */
+    using R_t = typename Base_class::R_t;                /*!< \brief Measurement noise covariance matrix type \f$p \times p\f$ */
+    using Q_t = typename Base_class::Q_t;                /*!< \brief Process noise covariance matrix type \f$n \times n\f$ */
+    using statecov_t = typename Base_class::statecov_t;  /*!< \brief Helper struct for passing around the state and its covariance in one variable */
+
+    using A_t = typename Base_class::A_t;                /*!< \brief System transition matrix type \f$n \times n\f$ */
+    using B_t = typename Base_class::B_t;                /*!< \brief Input to state mapping matrix type \f$n \times m\f$ */
+    using H_t = typename Base_class::H_t;                /*!< \brief State to measurement mapping matrix type \f$p \times n\f$ */
+    using S_t = Eigen::Matrix<double, n, n>;             /*!< \brief Square-root factor of the state covariance matrix type \f$n \times n\f$ */
+
+    /*!
+      * \brief Helper struct for passing around the state and the square-root factor of its covariance in one variable.
+      */
+    struct sqrt_statecov_t
+    {
+      x_t x;  /*!< \brief State vector. */
+      S_t S;  /*!< \brief Square-root factor of the state covariance matrix (\f$ \mathbf{P} = \mathbf{S}\mathbf{S}^\intercal \f$). */
+      ros::Time stamp = ros::Time(0); /*!< \brief ROS time stamp */
+    };
+    //}
+
+  public:
+  /*!
+    * \brief Convenience default constructor.
+    *
+    * This constructor should not be used if applicable. If used, the main constructor has to be called afterwards,
+    * before using this class, otherwise the object is invalid (not initialized).
+    */
+    sqrtLKF(){};
+
+  /*!
+    * \brief The main constructor.
+    *
+    * \param A             The state transition matrix.
+    * \param B             The input to state mapping matrix.
+    * \param H             The state to measurement mapping matrix.
+    */
+    sqrtLKF(const A_t& A, const B_t& B, const H_t& H) : Base_class(A, B, H){};
+
+    /* correct() method //{ */
+  /*!
+    * \brief Applies the correction (update, measurement, data) step of the Kalman filter in the square-root form.
+    *
+    * \param sc          The state and covariance factor to which the correction step is to be applied.
+    * \param z           The measurement vector to be used for correction.
+    * \param R           The measurement noise covariance matrix to be used for correction (must be positive definite).
+    * \return            The state and covariance factor after the correction update.
+    */
+    sqrt_statecov_t correct(const sqrt_statecov_t& sc, const z_t& z, const R_t& R) const
+    {
+      return correct(sc, z, R, this->H);
+    };
+
+  /*!
+    * \brief Applies the correction step of the Kalman filter in the square-root form with a measurement of an arbitrary length.
+    *
+    * This variant may be used to apply several different low-dimensional measurements using a single filter object.
+    *
+    * \param sc          The state and covariance factor to which the correction step is to be applied.
+    * \param z           The measurement vector to be used for correction.
+    * \param R           The measurement noise covariance matrix to be used for correction (must be positive definite).
+    * \param H           The state to measurement mapping matrix to be used for correction.
+    * \return            The state and covariance factor after the correction update.
+    */
+    template <int p_meas>
+    sqrt_statecov_t correct(const sqrt_statecov_t& sc, const Eigen::Matrix<double, p_meas, 1>& z, const Eigen::Matrix<double, p_meas, p_meas>& R,
+                            const Eigen::Matrix<double, p_meas, n>& H) const
+    {
+      // decorrelate the measurement, so that it can be applied as p_meas independent scalar measurements with a unit variance
+      const Eigen::LLT<Eigen::Matrix<double, p_meas, p_meas>> llt(R);
+      if (llt.info() != Eigen::Success)
+        throw typename Base_class::inverse_exception();
+      const Eigen::Matrix<double, p_meas, 1> z_dec = llt.matrixL().solve(z);
+      const Eigen::Matrix<double, p_meas, n> H_dec = llt.matrixL().solve(H);
+
+      sqrt_statecov_t ret = sc;
+      for (int it = 0; it < p_meas; it++)
+        correct_scalar(ret, z_dec(it), H_dec.row(it).transpose());
+      return ret;
+    }
+
+  /*!
+    * \brief Applies the correction (update, measurement, data) step of the Kalman filter.
+    *
+    * The covariance matrix is factorized, the correction is applied in the square-root form and the covariance is reconstructed.
+    *
+    * \param sc          The state and covariance to which the correction step is to be applied.
+    * \param z           The measurement vector to be used for correction.
+    * \param R           The measurement noise covariance matrix to be used for correction (must be positive definite).
+    * \return            The state and covariance after the correction update.
+    */
+    virtual statecov_t correct(const statecov_t& sc, const z_t& z, const R_t& R) const override
+    {
+      return fromSqrt(correct(toSqrt(sc), z, R));
+    };
+    //}
+
+    /* predict() method //{ */
+  /*!
+    * \brief Applies the prediction (time) step of the Kalman filter in the square-root form.
+    *
+    * \param sc          The state and covariance factor to which the prediction step is to be applied.
+    * \param u           The input vector to be used for prediction.
+    * \param Q           The process noise covariance matrix to be used for prediction (must be positive semi-definite).
+    * \param dt          Used to scale the process noise covariance \p Q.
+    * \return            The state and covariance factor after the prediction step.
+    *
+    * \note The returned factor is lower-triangular.
+    */
+    sqrt_statecov_t predict(const sqrt_statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const
+    {
+      sqrt_statecov_t ret;
+      ret.x = Base_class::state_predict(this->A, sc.x, this->B, u);
+      // the new factor is obtained from the QR decomposition of [A*S, sqrt(dt*Q)]^T
+      Eigen::Matrix<double, 2 * n, n> pre;
+      pre.template topRows<n>() = (this->A * sc.S).transpose();
+      pre.template bottomRows<n>() = (std::sqrt(std::max(dt, 0.0)) * factorize(Q)).transpose();
+      const Eigen::HouseholderQR<Eigen::Matrix<double, 2 * n, n>> qr(pre);
+      ret.S = qr.matrixQR().template topRows<n>().template triangularView<Eigen::Upper>().transpose();
+      return ret;
+    };
+
+  /*!
+    * \brief Applies the prediction (time) step of the Kalman filter.
+    *
+    * The covariance matrix is factorized, the prediction is applied in the square-root form and the covariance is reconstructed.
+    *
+    * \param sc          The state and covariance to which the prediction step is to be applied.
+    * \param u           The input vector to be used for prediction.
+    * \param Q           The process noise covariance matrix to be used for prediction (must be positive semi-definite).
+    * \param dt          Used to scale the process noise covariance \p Q.
+    * \return            The state and covariance after the prediction step.
+    */
+    virtual statecov_t predict(const statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const override
+    {
+      return fromSqrt(predict(toSqrt(sc), u, Q, dt));
+    };
+    //}
+
+    /* toSqrt() method //{ */
+  /*!
+    * \brief Converts the state and covariance to the state and a square-root factor of the covariance.
+    *
+    * \param sc          The state and covariance (the covariance must be positive semi-definite).
+    * \return            The state and a lower-triangular square-root factor of the covariance.
+    */
+    static sqrt_statecov_t toSqrt(const statecov_t& sc)
+    {
+      return {sc.x, factorize(sc.P), sc.stamp};
+    }
+    //}
+
+    /* fromSqrt() method //{ */
+  /*!
+    * \brief Converts the state and a square-root factor of the covariance to the state and covariance.
+    *
+    * \param sc          The state and a square-root factor of the covariance.
+    * \return            The state and covariance.
+    */
+    static statecov_t fromSqrt(const sqrt_statecov_t& sc)
+    {
+      statecov_t ret;
+      ret.x = sc.x;
+      ret.P.noalias() = sc.S * sc.S.transpose();
+      ret.stamp = sc.stamp;
+      return ret;
+    }
+    //}
+
+  protected:
+    /* correct_scalar() method //{ */
+    // the Potter's algorithm for a scalar measurement z = h^T*x with a unit variance
+    static void correct_scalar(sqrt_statecov_t& sc, const double z, const x_t& h)
+    {
+      const x_t f = sc.S.transpose() * h;
+      const double alpha = f.squaredNorm() + 1.0;
+      const x_t K = sc.S * f / alpha;
+      sc.x += K * (z - h.dot(sc.x));
+      const double gamma = 1.0 / (1.0 + std::sqrt(1.0 / alpha));
+      sc.S.noalias() -= gamma * K * f.transpose();
+    }
+    //}
+
+    /* factorize() method //{ */
+    // returns a lower-triangular factor L of a positive semi-definite matrix M, such that M = L*L^T
+    static S_t factorize(const P_t& M)
+    {
+      const Eigen::LLT<P_t> llt(M);
+      if (llt.info() == Eigen::Success)
+        return llt.matrixL();
+      // the Cholesky decomposition fails for singular matrices, so the more robust LDL^T decomposition is used as a fallback
+      const Eigen::LDLT<P_t> ldlt(M);
+      S_t L = ldlt.matrixL();
+      L = ldlt.transpositionsP().transpose() * (L * ldlt.vectorD().cwiseMax(0.0).cwiseSqrt().asDiagonal());
+      return L;
+    }
+    //}
   };
   //}
 
@@ -362,12 +910,64 @@ namespace mrs_lib
     virtual statecov_t predict(const statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const override;
     virtual statecov_t correct(const statecov_t& sc, const z_t& z, const R_t& R, int param = 0) const;
 
+  /*!
+    * \brief Enables or disables the steady-state mode.
+    *
+    * The system matrices and the measurement mappings are time-invariant for a fixed \p dt, so the covariance and the Kalman gain
+    * converge. In the steady-state mode, the converged gain and covariances are computed once for each measurement mapping
+    * (the \p param of correct()) by iterating the Riccati equation with the \p dt and \p Q of the last prediction and
+    * the \p R of the correction. After that, the covariance is not propagated anymore - the converged covariances are
+    * returned instead (the covariance passed in the \p sc argument is ignored) and the state is corrected using the converged gain. Whenever \p dt, \p Q or \p R differ from the values,
+    * for which the gain was computed, by more than the thresholds, the full update is applied instead (using the covariance
+    * passed in the \p sc argument). It is disabled by default. Changing the mode discards the converged gains.
+    *
+    * The gain for a measurement mapping is computed at its second correction with the same \p dt, \p Q and \p R, and again whenever
+    * they change and then stay the same for two consecutive corrections.
+    *
+    * \param enable          whether the steady-state mode should be used.
+    * \param dt_threshold    the largest absolute difference of \p dt, for which the converged gain is still used.
+    * \param noise_threshold the largest difference of \p Q and \p R relative to their norms, for which the converged gain is still used.
+    *
+    * \note The converged gain assumes that each correction is preceded by exactly one prediction.
+    * \note The predict() and correct() methods modify internal variables in this mode, so they must not be called concurrently.
+    */
+    void setSteadyState(const bool enable, const double dt_threshold = 1e-6, const double noise_threshold = 1e-6);
+
   public:
     x_t state_predict_optimized(const x_t& x_prev, const u_t& u, double dt) const;
     P_t covariance_predict_optimized(const P_t& P, const Q_t& Q, double dt) const;
 
   private:
     std::vector<H_t> m_Hs;
+
+  private:
+    // the converged gain and covariances for one measurement mapping
+    struct steady_state_t
+    {
+      bool valid = false;
+      double dt;
+      Q_t Q;
+      R_t R;
+      K_t K;
+      P_t P_prior;
+      P_t P_post;
+      double last_dt = -1.0;  // the values used in the last correction with this measurement mapping
+      Q_t last_Q;
+      R_t last_R;
+    };
+
+    bool m_steady_state = false;
+    double m_ss_dt_threshold = 1e-6;
+    double m_ss_noise_threshold = 1e-6;
+    mutable std::vector<steady_state_t> m_ss;  // one for each measurement mapping
+    mutable double m_last_dt = -1.0;             // dt of the last prediction
+    mutable Q_t m_last_Q;                        // Q of the last prediction
+    mutable int m_last_param = -1;               // measurement mapping of the last correction
+
+  private:
+    bool matches(const double dt1, const Q_t& Q1, const double dt2, const Q_t& Q2) const;
+    bool matches(const R_t& R1, const R_t& R2) const;
+    void compute_steady_state(steady_state_t& ss, const H_t& H) const;
   };
   //}
 
@@ -10,14 +10,17 @@
 #include <boost/circular_buffer.hpp>
 #include <mutex>
 #include <cmath>
-#include <vector>
-#include <optional>
+#include <limits>
+#include <set>
 
 namespace mrs_lib
 {
   /**
    * \brief Implementation of a median filter with a fixed-length buffer.
    *
+   * Besides the buffer, the values are kept sorted in two halves (the lower and the upper one), so that the median
+   * is updated in \f$ O(\log n) \f$ when a value is added or retired from the buffer and obtained in \f$ O(1) \f$.
+   *
    */
   class MedianFilter
   {
@@ -85,7 +88,7 @@ namespace mrs_lib
       /*!
        * \brief Add a new value to the buffer.
        *
-       * \note The median value will not be updated until the median() method is called (lazy evaluation).
+       * If the buffer is full, the oldest value is retired.
        *
        * \param value   the new value to be added to the buffer.
        */
@@ -108,8 +111,6 @@ namespace mrs_lib
        * The value is compliant if it's above the \p min_value, below the \p max_value
        * and its (absolute) difference from the current mean is below \p max_diff.
        *
-       * \note The median value will not be updated until the median() method is called (lazy evaluation).
-       *
        * \param value   the new value to be added to the buffer and checked.
        * \return        true if the value is compliant, false otherwise.
        */
@@ -134,8 +135,7 @@ namespace mrs_lib
       /*!
        * \brief Obtain the median.
        *
-       * If an up-to-date median value is available, it's not recalculated.
-       * Otherwise, the new median value is calculated and then returned (lazy evaluation).
+       * The median is kept up-to-date when adding values, so this method doesn't need to sort the buffer.
        *
        * \return        the current median value (returns \p nan if the input buffer is empty).
        */
@@ -185,19 +185,35 @@ namespace mrs_lib
       void setMaxDifference(const double max_diff);
 
     private:
+      // a strict weak ordering, which places NaNs after all other values (std::less would break the sorted sets)
+      struct less_t
+      {
+        bool operator()(const double a, const double b) const
+        {
+          return std::isnan(b) ? !std::isnan(a) : a < b;
+        }
+      };
+      using sorted_t = std::multiset<double, less_t>;
+
       // for thread-safety
       mutable std::recursive_mutex m_mtx;
       // the input buffer
       boost::circular_buffer<double> m_buffer;
-      // a helper buffer for sorting the input buffer
-      mutable std::vector<double> m_buffer_sorted;
-      // the last median value for lazy evaluation
-      mutable std::optional<double> m_median;
+      // the lower half of the sorted values in the buffer (contains the middle value for an odd number of values)
+      sorted_t m_lower;
+      // the upper half of the sorted values in the buffer
+      sorted_t m_upper;
 
       // parameters specified by the user
       double m_min_valid;
       double m_max_valid;
       double m_max_diff;
+
+    private:
+      sorted_t::node_type extractSorted(const double value);
+      void insertSorted(const double value, sorted_t::node_type&& node);
+      void rebalanceSorted();
+      void rebuildSorted();
   };
 
 } // namespace mrs_lib
@@ -0,0 +1,214 @@
+#ifndef MEDIAN_FILTER_N
+#define MEDIAN_FILTER_N
+
+/**  \file
+     \brief Defines the MedianFilterN class.
+     \author Matouš Vrba - matous.vrba@fel.cvut.cz
+ */
+
+#include <Eigen/Dense>
+#include <mutex>
+#include <cmath>
+#include <limits>
+
+namespace mrs_lib
+{
+  /**
+   * \brief Implementation of a multi-channel median filter with a fixed-length buffer.
+   *
+   * This class filters a stream of vectors, where each element (channel) is filtered independently in the same way as by the MedianFilter class.
+   * Unlike using a separate MedianFilter for each channel, all the channels share a single lock and a single ring buffer, and the constraints
+   * of the check() method are evaluated for all the channels at once.
+   *
+   * The buffered values are stored in the structure-of-arrays layout (the values of each channel are contiguous). Besides the buffer,
+   * the values of each channel are kept sorted, so when a value is added, its position is found using a binary search and only the values
+   * between the position of the new value and the position of the retired value are shifted. The median is then obtained in \f$ O(1) \f$.
+   *
+   * \tparam N  number of the filtered channels (length of the filtered vector).
+   *
+   */
+  template <int N>
+  class MedianFilterN
+  {
+    public:
+      using vec_t = Eigen::Matrix<double, N, 1>;    /*!< \brief Type of the filtered vector. */
+      using mask_t = Eigen::Array<bool, N, 1>;      /*!< \brief Type of the per-channel result of the check() method. */
+
+    public:
+      /*!
+       * \brief The main constructor.
+       *
+       * \param buffer_length   the number of last values to be kept in the buffer.
+       * \param min_value       values below this threshold will be discarded (won't be added to the buffer).
+       * \param max_value       values above this threshold will be discarded.
+       * \param max_diff        values that differ from the current median by more than this threshold will be discarded.
+       */
+      MedianFilterN(const size_t buffer_length, const vec_t& min_value = vec_t::Constant(-std::numeric_limits<double>::infinity()),
+                    const vec_t& max_value = vec_t::Constant(std::numeric_limits<double>::infinity()),
+                    const vec_t& max_diff = vec_t::Constant(std::numeric_limits<double>::infinity()));
+
+      /*!
+       * \brief A convenience empty constructor that will construct an invalid filter.
+       *
+       * \warning This constructor will construct an unusable filter with a zero-length buffer.
+       * To actually initialize this object, use the main constructor.
+       * You can use the initialized() method to check whether the object is valid.
+       *
+       */
+      MedianFilterN();
+
+      /*!
+       * \brief A convenience copy constructor.
+       *
+       * This constructor copies all data from the object that is being assigned from in a thread-safe manner.
+       *
+       * \param  other  the object to assign from.
+       *
+       */
+      MedianFilterN(const MedianFilterN& other);
+
+      /**
+       * \brief A convenience copy assignment operator.
+       *
+       * This operator copies all data from the object that is being assigned from in a thread-safe manner.
+       *
+       * \param  other  the object to assign from.
+       * \return        a reference to the object being assigned to.
+       */
+      MedianFilterN& operator=(const MedianFilterN& other);
+
+      /*!
+       * \brief Add a new vector to the buffer.
+       *
+       * If the buffer is full, the oldest vector is retired.
+       *
+       * \param value   the new vector to be added to the buffer.
+       */
+      void add(const vec_t& value);
+
+      /*!
+       * \brief Check whether the channels of a vector comply with the constraints.
+       *
+       * A channel is compliant if it's above the \p min_value, below the \p max_value
+       * and its (absolute) difference from the current median is below \p max_diff.
+       *
+       * \param value   the vector to be checked.
+       * \return        a mask, which is true for the compliant channels and false otherwise.
+       */
+      mask_t check(const vec_t& value);
+
+      /*!
+       * \brief Add a new vector to the buffer and check if its channels comply with the constraints.
+       *
+       * A channel is compliant if it's above the \p min_value, below the \p max_value
+       * and its (absolute) difference from the current median is below \p max_diff.
+       *
+       * \param value   the new vector to be added to the buffer and checked.
+       * \return        a mask, which is true for the compliant channels and false otherwise.
+       */
+      mask_t addCheck(const vec_t& value);
+
+      /*!
+       * \brief Clear the buffer of all values.
+       *
+       * Doesn't change the buffer's length set in the constructor or any other parameters, only clears all stored values.
+       */
+      void clear();
+
+      /*!
+       * \brief Check whether the buffer is filled with values.
+       *
+       * If true, adding a new vector will remove the oldest vector in the buffer.
+       *
+       * \return        true if the buffer contains \p buffer_length vectors.
+       */
+      bool full() const;
+
+      /*!
+       * \brief Obtain the per-channel median.
+       *
+       * \return        the current median values (returns \p nan if the input buffer is empty).
+       */
+      vec_t median() const;
+
+      /*!
+       * \brief Check whether the filter was initialized with a valid buffer length.
+       *
+       * \return true if the buffer length is larger than zero.
+       */
+      bool initialized() const;
+
+      /*!
+       * \brief Set a new size of the buffer.
+       *
+       * \note The median value may change. If the buffer is shortened, the newest values are discarded (the same as in MedianFilter).
+       *
+       * \param buffer_length   the new size of the buffer.
+       */
+      void setBufferLength(const size_t buffer_length);
+
+      /*!
+       * \brief Set new minimal thresholds for new values.
+       *
+       * \note The current buffer is not changed - the change only applies to new values.
+       *
+       * \param min_value   the new minimal values of new buffer elements.
+       */
+      void setMinValue(const vec_t& min_value);
+
+      /*!
+       * \brief Set new maximal thresholds for new values.
+       *
+       * \note The current buffer is not changed - the change only applies to new values.
+       *
+       * \param max_value   the new maximal values of new buffer elements.
+       */
+      void setMaxValue(const vec_t& max_value);
+
+      /*!
+       * \brief Set new maximal differences from median for new values.
+       *
+       * \note The current buffer is not changed - the change only applies to new values.
+       *
+       * \param max_diff   the new maximal differences of new buffer elements from the current median.
+       */
+      void setMaxDifference(const vec_t& max_diff);
+
+    private:
+      // a strict weak ordering, which places NaNs after all other values (the same as in MedianFilter)
+      struct less_t
+      {
+        bool operator()(const double a, const double b) const
+        {
+          return std::isnan(b) ? !std::isnan(a) : a < b;
+        }
+      };
+      // each column holds the values of one channel (structure-of-arrays)
+      using buffer_t = Eigen::Matrix<double, Eigen::Dynamic, N>;
+
+      // for thread-safety
+      mutable std::recursive_mutex m_mtx;
+      // the input ring buffer (its number of rows is the buffer length)
+      buffer_t m_buffer;
+      // index of the oldest row in the ring buffer
+      size_t m_first;
+      // number of the valid rows in the ring buffer
+      size_t m_size;
+      // the first m_size values of each column are the buffered values of the channel in ascending order
+      buffer_t m_sorted;
+
+      // parameters specified by the user
+      vec_t m_min_valid;
+      vec_t m_max_valid;
+      vec_t m_max_diff;
+
+    private:
+      void insertSorted(double* const sorted, const double value);
+      void replaceSorted(double* const sorted, const double old_value, const double new_value);
+  };
+
+} // namespace mrs_lib
+
+#include <mrs_lib/impl/median_filter_n.hpp>
+
+#endif
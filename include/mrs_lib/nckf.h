@@ -8,6 +8,8 @@
 
 #include <mrs_lib/lkf.h>
 #include <mrs_lib/ukf.h>
+#include <array>
+#include <utility>
 
 namespace mrs_lib
 {
@@ -88,6 +90,23 @@ namespace mrs_lib
       return K;
     }
     //}
+
+    /* correction_sequential_impl() method //{ */
+    virtual statecov_t correction_sequential_impl(const statecov_t& sc, const z_t& z, const z_t& R_diag, const H_t& H) const override
+    {
+      double inn_scale;
+      statecov_t ret = Base_class::correction_sequential(sc, z, R_diag, H, inn_scale);
+
+      // apply the norm constraint - this is equivalent to using the modified Kalman gain from computeKalmanGain(), because
+      // the unconstrained update of the state is dx = P*H^T*W^-1*inn and the normalized innovation squared is inn^T*W^-1*inn
+      const x_t x = ret.x;
+      const x_t dx = x - sc.x;
+      const double x_norm = x.norm();
+      ret.x = l/x_norm * x;
+      ret.P.noalias() -= (l/x_norm - 1.0) * x * dx.transpose() / inn_scale;
+      return ret;
+    }
+    //}
     
   };
   //}
@@ -104,6 +123,9 @@ namespace mrs_lib
   * The norm constraint is specified in the constructor together with the indices of the
   * states to which the constraint applies.
   *
+  * If the indices of the norm-constrained states are known at compile time, NCLKF_partial_static should be preferred,
+  * because it avoids the runtime selection of the norm-constrained rows and columns.
+  *
   * Example usage:
   * \include src/nckf/nckf_tests.cpp
   *
@@ -275,10 +297,197 @@ namespace mrs_lib
       return K;
     }
     //}
+
+    /* correction_sequential_impl() method //{ */
+    virtual statecov_t correction_sequential_impl(const statecov_t& sc, const z_t& z, const z_t& R_diag, const H_t& H) const override
+    {
+      // the partial norm constraint uses a different innovation, which requires the inverse of the whole innovation covariance,
+      // so the standard correction is used instead
+      const R_t R = R_diag.asDiagonal();
+      return this->correction_impl(sc, z, R, H);
+    }
+    //}
     
   };
   //}
 
+  /* class NCLKF_partial_static //{ */
+
+  /**
+  * \brief This class implements the partially norm-constrained linear Kalman filter \cite NCLKF with the indices known at compile time.
+  *
+  * This class is equivalent to NCLKF_partial, but the indices of the norm-constrained states are specified as the last
+  * template parameters instead of in the constructor. The selection of the norm-constrained rows and columns
+  * (and writing them back) is then resolved at compile time - if the indices are contiguous (e.g. 3, 4, 5), the selections
+  * are Eigen block views without any copying. Otherwise, the selection is unrolled to a fixed sequence of row/column copies
+  * without any loops or runtime index checks.
+  *
+  * Example declaration for a 9-state system with the norm constraint applied to the states 3, 4 and 5:
+  * \code{.cpp}
+  * using nclkf_t = mrs_lib::NCLKF_partial_static<9, 1, 3, 3, 4, 5>;
+  * \endcode
+  *
+  * \tparam n_states                  number of states of the system (length of the \f$ \mathbf{x} \f$ vector).
+  * \tparam n_inputs                  number of inputs of the system (length of the \f$ \mathbf{u} \f$ vector).
+  * \tparam n_measurements            number of measurements of the system (length of the \f$ \mathbf{z} \f$ vector).
+  * \tparam norm_constrained_indices  indices of the norm-constrained states in the state vector.
+  *
+  */
+  template <int n_states, int n_inputs, int n_measurements, int... norm_constrained_indices>
+  class NCLKF_partial_static : public NCLKF<n_states, n_inputs, n_measurements>
+  {
+  public:
+    /* NCLKF_partial_static definitions (typedefs, constants etc) //{ */
+    static const int n = n_states;                             /*!< \brief Length of the state vector of the system. */
+    static const int m = n_inputs;                             /*!< \brief Length of the input vector of the system. */
+    static const int p = n_measurements;                       /*!< \brief Length of the measurement vector of the system. */
+    static const int nq = sizeof...(norm_constrained_indices); /*!< \brief Number of states to which the norm constraint applies. */
+    using Base_class = NCLKF<n, m, p>;                         /*!< \brief Base class of this class. */
+
+    using x_t = typename Base_class::x_t;                /*!< \brief State vector type \f$n \times 1\f$ */
+    using u_t = typename Base_class::u_t;                /*!< \brief Input vector type \f$m \times 1\f$ */
+    using z_t = typename Base_class::z_t;                /*!< \brief Measurement vector type \f$p \times 1\f$ */
+    using P_t = typename Base_class::P_t;                /*!< \brief State uncertainty covariance matrix type \f$n \times n\f$ */
+    using R_t = typename Base_class::R_t;                /*!< \brief Measurement noise covariance matrix type \f$p \times p\f$ */
+    using Q_t = typename Base_class::Q_t;                /*!< \brief Process noise covariance matrix type \f$n \times n\f$ */
+    using statecov_t = typename Base_class::statecov_t;  /*!< \brief Helper struct for passing around the state and its covariance in one variable */
+
+    using A_t = typename Base_class::A_t;                /*!< \brief System transition matrix type \f$n \times n\f$ */
+    using B_t = typename Base_class::B_t;                /*!< \brief Input to state mapping matrix type \f$n \times m\f$ */
+    using H_t = typename Base_class::H_t;                /*!< \brief State to measurement mapping matrix type \f$p \times n\f$ */
+    using K_t = typename Base_class::K_t;                /*!< \brief Kalman gain matrix type \f$n \times p\f$ */
+
+    using xq_t = Eigen::Matrix<double, nq, 1>;           /*!< \brief Norm-constrained states vector type \f$ n_q \times 1 \f$ */
+    using Hq_t = Eigen::Matrix<double, p, nq>;           /*!< \brief Norm-constrained measurement mapping type \f$ p \times n_q \f$ */
+    using Kq_t = Eigen::Matrix<double, nq, p>;           /*!< \brief Norm-constrained kalman gain type \f$ n_q \times p \f$ */
+
+    static constexpr std::array<int, nq> indices = {norm_constrained_indices...}; /*!< \brief Indices of the norm-constrained states. */
+    //}
+
+  public:
+  /*!
+    * \brief Convenience default constructor.
+    *
+    * This constructor should not be used if applicable. If used, the main constructor has to be called afterwards,
+    * before using this class, otherwise the object is invalid (not initialized).
+    */
+    NCLKF_partial_static(){};
+
+  /*!
+    * \brief The main constructor.
+    *
+    * \param A                         State transition matrix of the system (n x n).
+    * \param B                         Input to state mapping matrix of the system (n x m).
+    * \param H                         State to measurement mapping matrix of the system (p x n).
+    * \param l                         The norm constraint, applied to the specified states.
+    */
+    NCLKF_partial_static(const A_t& A, const B_t& B, const H_t& H, const double l) : Base_class(A, B, H, l) {};
+
+  private:
+    static_assert(nq > 0, "At least one norm-constrained state has to be specified!");
+    static_assert(((norm_constrained_indices >= 0) && ...), "Index of a norm-constrained state cannot be less than zero!");
+    static_assert(n < 0 || ((norm_constrained_indices < n) && ...), "Index of a norm-constrained state has to be lower than the number of states!");
+
+    /* helper methods for Eigen matrix subscripting //{ */
+
+    static constexpr bool is_contiguous()
+    {
+      for (int it = 1; it < nq; it++)
+        if (indices[it] != indices[0] + it)
+          return false;
+      return true;
+    }
+
+    // returns the norm-constrained rows of mat - a block view for contiguous indices
+    template <typename Derived>
+    static auto select_rows(const Eigen::MatrixBase<Derived>& mat)
+    {
+      if constexpr (is_contiguous())
+        return mat.template middleRows<nq>(indices[0]);
+      else
+        return select_rows(mat, std::make_index_sequence<nq>());
+    }
+
+    template <typename Derived, size_t... its>
+    static auto select_rows(const Eigen::MatrixBase<Derived>& mat, std::index_sequence<its...>)
+    {
+      Eigen::Matrix<typename Derived::Scalar, nq, Derived::ColsAtCompileTime> ret(nq, mat.cols());
+      ((ret.row(its) = mat.row(indices[its])), ...);
+      return ret;
+    }
+
+    // returns the norm-constrained columns of mat - a block view for contiguous indices
+    template <typename Derived>
+    static auto select_cols(const Eigen::MatrixBase<Derived>& mat)
+    {
+      if constexpr (is_contiguous())
+        return mat.template middleCols<nq>(indices[0]);
+      else
+        return select_cols(mat, std::make_index_sequence<nq>());
+    }
+
+    template <typename Derived, size_t... its>
+    static auto select_cols(const Eigen::MatrixBase<Derived>& mat, std::index_sequence<its...>)
+    {
+      Eigen::Matrix<typename Derived::Scalar, Derived::RowsAtCompileTime, nq> ret(mat.rows(), nq);
+      ((ret.col(its) = mat.col(indices[its])), ...);
+      return ret;
+    }
+
+    // writes from_mat to the norm-constrained rows of to_mat
+    template <typename Derived>
+    static void set_rows(const Kq_t& from_mat, Eigen::MatrixBase<Derived>& to_mat)
+    {
+      if constexpr (is_contiguous())
+        to_mat.template middleRows<nq>(indices[0]) = from_mat;
+      else
+        set_rows(from_mat, to_mat, std::make_index_sequence<nq>());
+    }
+
+    template <typename Derived, size_t... its>
+    static void set_rows(const Kq_t& from_mat, Eigen::MatrixBase<Derived>& to_mat, std::index_sequence<its...>)
+    {
+      ((to_mat.row(indices[its]) = from_mat.row(its)), ...);
+    }
+
+    //}
+
+  protected:
+    /* computeKalmanGain() method //{ */
+    virtual K_t computeKalmanGain(const statecov_t& sc, const z_t& z, const R_t& R, const H_t& H) const override
+    {
+      const R_t W = H * sc.P * H.transpose() + R;
+      const R_t W_inv = Base_class::invert_W(W);
+      K_t K = sc.P * H.transpose() * W_inv;
+
+      // calculate the kalman gain for the norm-constrained states (the same as in NCLKF_partial)
+      {
+        const Kq_t K_orig = select_rows(K);
+        const z_t inn = z - (select_cols(H) * select_rows(sc.x)); // innovation
+        const xq_t x = select_rows(sc.x) + K_orig * inn;
+        const double inn_scale = inn.transpose() * W_inv * inn;
+
+        const double x_norm = x.norm();
+        const Kq_t Kq = K_orig + (Base_class::l/x_norm - 1.0) * x * (inn.transpose() * W_inv) / inn_scale;
+        set_rows(Kq, K);
+      }
+
+      return K;
+    }
+    //}
+
+    /* correction_sequential_impl() method //{ */
+    virtual statecov_t correction_sequential_impl(const statecov_t& sc, const z_t& z, const z_t& R_diag, const H_t& H) const override
+    {
+      // the same as in NCLKF_partial - the standard correction is used
+      const R_t R = R_diag.asDiagonal();
+      return this->correction_impl(sc, z, R, H);
+    }
+    //}
+
+  };
+  //}
+
   /* class NCUKF //{ */
   template <int n_states, int n_inputs, int n_measurements>
   class NCUKF : public UKF<n_states, n_inputs, n_measurements>
@@ -322,33 +531,22 @@ namespace mrs_lib
       const X_t S = Base_class::computeSigmas(x, P);
     
       // propagate sigmas through the observation model
-      Z_t Z_exp;
-      for (int i = 0; i < Base_class::w; i++)
-      {
-        Z_exp.col(i) = Base_class::m_observation_model(S.col(i));
-      }
+      const Z_t Z_exp = Base_class::observeSigmas(S, z.rows());
     
       // compute expected measurement
-      z_t z_exp = z_t::Zero();
-      for (int i = 0; i < Base_class::w; i++)
-      {
-        z_exp += Base_class::m_Wm(i) * Z_exp.col(i);
-      }
+      const z_t z_exp = Z_exp * Base_class::m_Wm;
+    
+      // the weighted deviations of the measurement sigmas are shared by both of the following products
+      const Z_t Z_dev = Z_exp.colwise() - z_exp;
+      const Z_t Z_dev_w = Z_dev * Base_class::m_Wc.asDiagonal();
     
       // compute the covariance of measurement
-      Pzz_t Pzz = Pzz_t::Zero();
-      for (int i = 0; i < Base_class::w; i++)
-      {
-        Pzz += Base_class::m_Wc(i) * (Z_exp.col(i) - z_exp) * (Z_exp.col(i) - z_exp).transpose();
-      }
-      Pzz += R;
+      Pzz_t Pzz = R;
+      Pzz.noalias() += Z_dev_w * Z_dev.transpose();
     
       // compute cross covariance
-      K_t Pxz = K_t::Zero();
-      for (int i = 0; i < Base_class::w; i++)
-      {
-        Pxz += Base_class::m_Wc(i) * (S.col(i) - x) * (Z_exp.col(i) - z_exp).transpose();
-      }
+      K_t Pxz;
+      Pxz.noalias() = (S.colwise() - x) * Z_dev_w.transpose();
     
       // compute Kalman gain
       const z_t inn = (z - z_exp); // innovation
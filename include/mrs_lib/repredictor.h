@@ -5,6 +5,13 @@
 #include <boost/circular_buffer.hpp>
 #include <std_msgs/Time.h>
 #include <functional>
+#include <vector>
+#include <algorithm>
+#include <variant>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <memory>
 #include <ros/ros.h>
 #include <mrs_lib/utils.h>
 
@@ -22,8 +29,10 @@ namespace mrs_lib
    *
    * To accomodate this, the Repredictor keeps a buffer of N last inputs and measurements (N is specified
    * in the constructor). This buffer is then used to re-predict the desired state to a specific time, as
-   * requested by the user. Note that the re-prediction is evaluated in a lazy manner only when the user requests it,
-   * so it goes through the whole history buffer every time a prediction is requested.
+   * requested by the user. Note that the re-prediction is evaluated in a lazy manner only when the user requests it.
+   * The posterior state and covariance at each history point is cached, so that only the part of the history buffer following
+   * the oldest newly added element has to be re-evaluated. A prediction to a time after the newest history point
+   * with no new elements added since the last one thus only costs a single prediction step.
    *
    * The Repredictor utilizes a fusion Model (specified as the template parameter), which should implement
    * the predict() and correct() methods. This Model is used for fusing the system inputs and measurements
@@ -31,6 +40,10 @@ namespace mrs_lib
    * \note The Model should be able to accomodate predictions with varying time steps in order for
    * the Repredictor to work correctly (see eg. the varstepLKF class).
    *
+   * The history buffer may also be used to obtain smoothed estimates of past states using the Rauch-Tung-Striebel
+   * smoother \cite RTS (see the smoothTo() and smoothedHistory() methods). For this, the Model also has to implement
+   * the getA() method, returning the state transition matrix for a given time step (see eg. the LKF class).
+   *
    * \tparam Model                  the prediction and correction model (eg. a Kalman Filter).
    * \tparam disable_reprediction   if true, reprediction is disabled and the class will act like a dumb LKF (for evaluation purposes).
    *
@@ -50,6 +63,39 @@ namespace mrs_lib
     using statecov_t = typename Model::statecov_t;    /*!< \brief Helper struct for passing around the state and its covariance in one variable */
     using ModelPtr = typename std::shared_ptr<Model>; /*!< \brief Shorthand type for a shared pointer-to-Model */
 
+    /*!
+     * \brief Helper struct for passing a measurement to the addMeasurements() method.
+     */
+    struct measurement_t
+    {
+      z_t z;                    /*!< \brief The measurement vector. */
+      R_t R;                    /*!< \brief The measurement noise covariance matrix, corresponding to the measurement vector. */
+      ros::Time stamp;          /*!< \brief Time stamp of the measurement vector and covariance matrix. */
+      ModelPtr model = nullptr; /*!< \brief Optional pointer to a specific Model to be used with this measurement (the default one is used if nullptr). */
+      int meas_id = -1;         /*!< \brief Optional identifier of the measurement. */
+    };
+
+    /*!
+     * \brief Helper struct with statistics of the Repredictor usage, returned by the getStatistics() method.
+     *
+     * The delay of a measurement is the difference between the stamp of the newest history point and the stamp of the measurement
+     * at the time of its addition. Only measurements older than the newest history point are counted as out-of-sequence.
+     */
+    struct statistics_t
+    {
+      uint64_t n_measurements = 0;          /*!< \brief Number of added measurements (including the dropped ones). */
+      uint64_t n_out_of_sequence = 0;       /*!< \brief Number of measurements, which were older than the newest history point. */
+      uint64_t n_dropped = 0;               /*!< \brief Number of system inputs and measurements dropped because they were older than the oldest history point. */
+      double max_delay = 0.0;               /*!< \brief The longest delay of a measurement in seconds. */
+      double delay_bin_width = 0.0;         /*!< \brief Width of one bin of the delay histogram in seconds. */
+      std::vector<uint64_t> delay_histogram; /*!< \brief Histogram of the measurement delays (the last bin also contains all longer delays). */
+      uint64_t n_predictions = 0;           /*!< \brief Number of calls of predictTo(). */
+      uint64_t n_replayed = 0;              /*!< \brief Total number of history points, which were replayed during predictTo(). */
+      uint64_t max_replayed = 0;            /*!< \brief The largest number of history points replayed during one predictTo(). */
+      double replay_time = 0.0;             /*!< \brief Total wall time spent replaying the history during predictTo() in seconds. */
+      double max_replay_time = 0.0;         /*!< \brief The longest wall time spent replaying the history during one predictTo() in seconds. */
+    };
+
     //}
 
     /* predictTo() method //{ */
@@ -67,36 +113,19 @@ namespace mrs_lib
     std::enable_if_t<!check, statecov_t> predictTo(const ros::Time& to_stamp)
     {
       assert(!m_history.empty());
-      auto hist_it = std::begin(m_history);
-      if (hist_it->is_measurement)
-      {
-        // if the first history point is measurement, don't use it for correction (to prevent it from being used twice)
-        hist_it->is_measurement = false;
-      }
-      // cur_stamp corresponds to the time point of cur_sc estimation
-      auto cur_stamp = hist_it->stamp;
-      // cur_sc is the current state and covariance estimate
-      auto cur_sc = m_sc;
-      do
-      {
-        cur_sc.stamp = hist_it->stamp;
-        // do the correction if current history point is a measurement
-        if ((hist_it->is_measurement))
-          cur_sc = correctFrom(cur_sc, *hist_it);
-
-        // decide whether to predict to the next history point or straight to the desired stamp already
-        // (whichever comes sooner or directly to the desired stamp if no further history point is available)
-        ros::Time next_stamp = to_stamp;
-        if ((hist_it + 1) != std::end(m_history) && (hist_it + 1)->stamp <= to_stamp)
-          next_stamp = (hist_it + 1)->stamp;
-
-        // do the prediction
-        cur_sc = predictFrom(cur_sc, *hist_it, cur_stamp, next_stamp);
-        cur_stamp = next_stamp;
-
-        // increment the history pointer
-        hist_it++;
-      } while (hist_it != std::end(m_history) && hist_it->stamp <= to_stamp);
+      // find the last history point, which is not newer than the desired stamp (or the first one if all are newer)
+      const auto next_it = std::upper_bound(std::begin(m_history), std::end(m_history), to_stamp, &Repredictor<Model>::earlier);
+      const auto hist_it = next_it == std::begin(m_history) ? next_it : next_it - 1;
+      const size_t idx = hist_it - std::begin(m_history);
+      // make sure that the cached posteriors are up to date up to this history point
+      // (the posterior of the oldest history point is always known, so it is not counted as replayed)
+      const size_t n_valid = std::max<size_t>(m_n_cached, 1);
+      const size_t n_replayed = idx + 1 > n_valid ? idx + 1 - n_valid : 0;
+      const auto replay_start = std::chrono::steady_clock::now();
+      const auto& info = updateCache(idx);
+      m_stats.addReplay(n_replayed, std::chrono::duration<double>(std::chrono::steady_clock::now() - replay_start).count());
+      // predict from the cached posterior straight to the desired stamp
+      auto cur_sc = predictFrom(info.sc, inputAt(idx), info.stamp, to_stamp);
       cur_sc.stamp = to_stamp;
       return cur_sc;
     }
@@ -118,12 +147,85 @@ namespace mrs_lib
     {
       assert(!m_history.empty());
       const auto& info = m_history.front();
-      auto sc = predictFrom(m_sc, info, info.stamp, to_stamp);
+      auto sc = predictFrom(m_sc, info.input(), info.stamp, to_stamp);
       sc.stamp = to_stamp;
       return sc;
     }
     //}
 
+    /* smoothTo() method //{ */
+    /*!
+     * \brief Estimates the smoothed system state and covariance matrix at the specified time.
+     *
+     * In contrast to predictTo(), the estimate also takes into account all system inputs and measurements newer than
+     * the specified time, which are present in the history buffer. A Rauch-Tung-Striebel backward pass \cite RTS is run
+     * from the newest history point to the specified time, reusing the cached forward posteriors. The results of the
+     * backward pass are cached as well until new data are added to the history buffer, so only the part of the history
+     * which was not yet smoothed has to be processed on subsequent calls.
+     *
+     * \param stamp      The desired time at which the smoothed state vector and covariance matrix should be estimated.
+     * \return           Returns the smoothed state vector and covariance matrix in a single struct.
+     *
+     * \note If \p stamp is newer than the newest history point, this is equivalent to calling predictTo().
+     *
+     */
+    template<bool check=disable_reprediction>
+    std::enable_if_t<!check, statecov_t> smoothTo(const ros::Time& stamp)
+    {
+      assert(!m_history.empty());
+      // find the first history point, which is newer than the desired stamp
+      const auto next_it = std::upper_bound(std::begin(m_history), std::end(m_history), stamp, &Repredictor<Model>::earlier);
+      // there is no newer data to be used for the smoothing
+      if (next_it == std::end(m_history))
+        return predictTo(stamp);
+
+      statecov_t ret;
+      if (next_it == std::begin(m_history))
+      {
+        // predict from the oldest history point (same as predictTo() does in this case)
+        ret = predictFrom(smoothBackward(0), inputAt(0), m_history.front().stamp, stamp);
+      }
+      else
+      {
+        const size_t prev_idx = next_it - std::begin(m_history) - 1;
+        const statecov_t smoothed_next = smoothBackward(prev_idx + 1);
+        const info_t& prev = m_history[prev_idx];
+        if (prev.stamp == stamp)
+          return smoothBackward(prev_idx);
+        // the estimate at the desired stamp is treated as an additional history point without a measurement
+        const statecov_t sc = predictFrom(prev.sc, inputAt(prev_idx), prev.stamp, stamp);
+        ret = rtsStep(sc, inputAt(prev_idx), stamp, next_it->stamp, smoothed_next);
+      }
+      ret.stamp = stamp;
+      return ret;
+    }
+    //}
+
+    /* smoothedHistory() method //{ */
+    /*!
+     * \brief Returns smoothed estimates of the system state and covariance matrix at the history points within a time window.
+     *
+     * The estimates are obtained using the Rauch-Tung-Striebel backward pass \cite RTS over the history buffer (see smoothTo()).
+     *
+     * \param lag        Duration of the time window before the newest history point (the fixed lag of the smoother).
+     * \return           Returns the smoothed state vectors and covariance matrices at the history points in the window, ordered from the oldest.
+     *
+     */
+    template<bool check=disable_reprediction>
+    std::enable_if_t<!check, std::vector<statecov_t>> smoothedHistory(const ros::Duration& lag)
+    {
+      assert(!m_history.empty());
+      const auto from_it = std::lower_bound(std::begin(m_history), std::end(m_history), m_history.back().stamp - lag, &Repredictor<Model>::earlier);
+      const size_t from_idx = from_it - std::begin(m_history);
+      smoothBackward(from_idx);
+      std::vector<statecov_t> ret;
+      ret.reserve(m_history.size() - from_idx);
+      for (size_t it = from_idx; it < m_history.size(); it++)
+        ret.push_back(m_smoothed[m_history.size() - 1 - it]);
+      return ret;
+    }
+    //}
+
     /* addInputChangeWithNoise() method //{ */
     /*!
      * \brief Adds one system input to the history buffer, removing the oldest element in the buffer if it is full.
@@ -140,15 +242,11 @@ namespace mrs_lib
     template<bool check=disable_reprediction>
     std::enable_if_t<!check> addInputChangeWithNoise(const u_t& u, const Q_t& Q, const ros::Time& stamp, const ModelPtr& model = nullptr)
     {
-      const info_t info(stamp, u, Q, model);
+      const info_t info(stamp, input_info_t{u, Q, modelIndex(model)});
       // find the next point in the history buffer
       const auto next_it = std::lower_bound(std::begin(m_history), std::end(m_history), info, &Repredictor<Model>::earlier);
       // add the point to the history buffer
-      const auto added = addInfo(info, next_it);
-      // update all measurements following the newly added system input up to the next system input
-      if (added != std::end(m_history))
-        for (auto it = added + 1; it != std::end(m_history) && it->is_measurement; it++)
-          it->updateUsing(info);
+      addInfo(info, next_it);
     }
 
     /*!
@@ -168,10 +266,8 @@ namespace mrs_lib
     {
       if (m_history.empty())
         m_history.push_back({stamp});
-      m_history.front().u = u;
-      m_history.front().Q = Q;
+      m_history.front().data = input_info_t{u, Q, modelIndex(model)};
       m_history.front().stamp = stamp;
-      m_history.front().predict_model = model;
     }
     //}
 
@@ -194,15 +290,11 @@ namespace mrs_lib
       // find the next point in the history buffer
       const auto next_it = std::lower_bound(std::begin(m_history), std::end(m_history), stamp, &Repredictor<Model>::earlier);
       // get the previous history point (or the first one to avoid out of bounds)
-      const auto prev_it = next_it == std::begin(m_history) ? next_it : next_it - 1;
+      const size_t prev_idx = next_it == std::begin(m_history) ? 0 : next_it - std::begin(m_history) - 1;
       // initialize a new history info point
-      const info_t info(stamp, u, prev_it->Q, model);
+      const info_t info(stamp, input_info_t{u, inputAt(prev_idx).Q, modelIndex(model)});
       // add the point to the history buffer
-      const auto added = addInfo(info, next_it);
-      // update all measurements following the newly added system input up to the next system input
-      if (added != std::end(m_history))
-        for (auto it = added + 1; it != std::end(m_history) && it->is_measurement; it++)
-          it->updateUsing(info);
+      addInfo(info, next_it);
     }
 
     /*!
@@ -221,9 +313,10 @@ namespace mrs_lib
     {
       if (m_history.empty())
         m_history.push_back({stamp});
-      m_history.front().u = u;
+      auto& inpt = std::get<input_info_t>(m_history.front().data);
+      inpt.u = u;
+      inpt.model = modelIndex(model);
       m_history.front().stamp = stamp;
-      m_history.front().predict_model = model;
     }
     //}
 
@@ -246,15 +339,11 @@ namespace mrs_lib
       // find the next point in the history buffer
       const auto next_it = std::lower_bound(std::begin(m_history), std::end(m_history), stamp, &Repredictor<Model>::earlier);
       // get the previous history point (or the first one to avoid out of bounds)
-      const auto prev_it = next_it == std::begin(m_history) ? next_it : next_it - 1;
+      const size_t prev_idx = next_it == std::begin(m_history) ? 0 : next_it - std::begin(m_history) - 1;
       // initialize a new history info point
-      const info_t info(stamp, prev_it->u, Q, model);
+      const info_t info(stamp, input_info_t{inputAt(prev_idx).u, Q, modelIndex(model)});
       // add the point to the history buffer
-      const auto added = addInfo(info, next_it);
-      // update all measurements following the newly added system input up to the next system input
-      if (added != std::end(m_history))
-        for (auto it = added + 1; it != std::end(m_history) && it->is_measurement; it++)
-          it->updateUsing(info);
+      addInfo(info, next_it);
     }
 
     /*!
@@ -273,9 +362,10 @@ namespace mrs_lib
     {
       if (m_history.empty())
         m_history.push_back({stamp});
-      m_history.front().Q = Q;
+      auto& inpt = std::get<input_info_t>(m_history.front().data);
+      inpt.Q = Q;
+      inpt.model = modelIndex(model);
       m_history.front().stamp = stamp;
-      m_history.front().predict_model = model;
     }
     //}
 
@@ -298,10 +388,9 @@ namespace mrs_lib
       assert(!m_history.empty());
       // helper variable for searching of the next point in the history buffer
       const auto next_it = std::lower_bound(std::begin(m_history), std::end(m_history), stamp, &Repredictor<Model>::earlier);
-      // get the previous history point (or the first one to avoid out of bounds)
-      const auto prev_it = next_it == std::begin(m_history) ? next_it : next_it - 1;
       // initialize a new history info point
-      const info_t info(stamp, z, R, model, *prev_it, meas_id);
+      const info_t info(stamp, meas_info_t{z, R, modelIndex(model), static_cast<int>(meas_id)});
+      m_stats.addMeasurement((m_history.back().stamp - stamp).toSec());
       // add the point to the history buffer
       addInfo(info, next_it);
     }
@@ -326,13 +415,193 @@ namespace mrs_lib
       auto& info = m_history.front();
       const ros::Time to_stamp = stamp > info.stamp ? stamp : info.stamp;
       const auto sc = predictTo(to_stamp);
-      info.z = z;
-      info.R = R;
+      // the only history point keeps the system input, the measurement is applied right away
       info.stamp = to_stamp;
-      info.is_measurement = true;
-      info.meas_id = meas_id;
-      info.correct_model = model;
-      m_sc = correctFrom(sc, info);
+      m_sc = correctFrom(sc, meas_info_t{z, R, modelIndex(model), static_cast<int>(meas_id)});
+    }
+    //}
+
+    /* addMeasurements() method //{ */
+    /*!
+     * \brief Adds a batch of measurements to the history buffer, removing the oldest elements in the buffer if it is full.
+     *
+     * This is equivalent to calling addMeasurement() for each of the measurements, but the batch is merged into the history buffer
+     * in a single pass, which is more efficient for a larger number of measurements (eg. a burst of delayed measurements from one sensor).
+     * The measurements do not have to be sorted.
+     *
+     * \param measurements  A range (eg. an std::vector) of the measurements to be added.
+     *
+     * \note Measurements older than the oldest element in the history buffer will not be added. If the buffer overflows, the oldest
+     * elements after merging the new measurements are removed (which may include some of the new measurements).
+     *
+     */
+    template<typename Range, bool check=disable_reprediction>
+    std::enable_if_t<!check> addMeasurements(const Range& measurements)
+    {
+      assert(!m_history.empty());
+      // prepare the new history points, sorted by their stamps
+      std::vector<info_t> batch;
+      for (const auto& meas : measurements)
+      {
+        m_stats.addMeasurement((m_history.back().stamp - meas.stamp).toSec());
+        // ignore measurements older than the oldest element in the history buffer
+        if (meas.stamp <= m_history.front().stamp)
+        {
+          m_stats.addDropped();
+          ROS_WARN_STREAM_THROTTLE(1.0, "[Repredictor]: Added history point is older than the oldest by "
+                                            << (m_history.front().stamp - meas.stamp).toSec()
+                                            << "s. Ignoring it! Consider increasing the history buffer size (currently: " << m_history.size() << ")");
+          continue;
+        }
+        batch.emplace_back(meas.stamp, meas_info_t{meas.z, meas.R, modelIndex(meas.model), meas.meas_id});
+      }
+      if (batch.empty())
+        return;
+      std::stable_sort(std::begin(batch), std::end(batch), &Repredictor<Model>::earlier);
+
+      // index of the first new history point in the history buffer (before the oldest elements are possibly thrown out)
+      size_t first_pos = std::lower_bound(std::begin(m_history), std::end(m_history), batch.front(), &Repredictor<Model>::earlier) - std::begin(m_history);
+      const size_t n_total = m_history.size() + batch.size();
+      // check if adding the new elements would throw out some of the oldest ones
+      if (n_total > m_history.capacity())
+      {
+        const size_t n_drop = n_total - m_history.capacity();
+        if (n_drop < first_pos)
+        {
+          // an original element will be the oldest one and its cached posterior stays valid
+          m_sc = updateCache(n_drop).sc;
+          m_front_input = inputAt(n_drop);
+          m_n_cached = std::min(m_n_cached, first_pos) - n_drop;
+          m_history.erase_begin(n_drop);
+          first_pos -= n_drop;
+        }
+        else
+        {
+          // go through the merged history points up to the new oldest one to find its posterior
+          const info_t* prev = &updateCache(first_pos - 1);
+          const input_info_t* inpt = &inputAt(first_pos - 1);
+          statecov_t sc = prev->sc;
+          size_t hist_idx = first_pos;
+          size_t batch_idx = 0;
+          bool oldest_is_new = false;
+          for (size_t it = first_pos; it <= n_drop; it++)
+          {
+            oldest_is_new = batch_idx < batch.size() && (hist_idx == m_history.size() || !earlier(m_history[hist_idx], batch[batch_idx]));
+            const info_t* cur = oldest_is_new ? &batch[batch_idx++] : &m_history[hist_idx++];
+            sc = predictFrom(sc, *inpt, prev->stamp, cur->stamp);
+            if (cur->is_measurement())
+              sc = correctFrom(sc, cur->meas());
+            else
+              inpt = &cur->input();
+            prev = cur;
+          }
+          m_sc = sc;
+          m_front_input = *inpt;
+          m_n_cached = 0;
+          // throw out all the history points before the new oldest one
+          m_history.erase_begin(oldest_is_new ? hist_idx : hist_idx - 1);
+          batch.erase(std::begin(batch), std::begin(batch) + (oldest_is_new ? batch_idx - 1 : batch_idx));
+          // all of the new measurements may have been thrown out as well
+          if (batch.empty())
+            return;
+          first_pos = std::lower_bound(std::begin(m_history), std::end(m_history), batch.front(), &Repredictor<Model>::earlier) - std::begin(m_history);
+        }
+      }
+      else
+      {
+        // all cached posteriors from the first new element onward are invalidated
+        m_n_cached = std::min(m_n_cached, first_pos);
+      }
+
+      // the smoothed estimates are affected by any new data
+      m_smoothed.clear();
+
+      // merge the new history points into the history buffer from the back (only the elements after the first new one are moved)
+      const size_t n_orig = m_history.size();
+      m_history.resize(n_orig + batch.size(), batch.front());
+      size_t hist_idx = n_orig;
+      size_t batch_idx = batch.size();
+      for (size_t it = m_history.size(); batch_idx > 0; it--)
+      {
+        if (hist_idx > first_pos && !earlier(m_history[hist_idx - 1], batch[batch_idx - 1]))
+          m_history[it - 1] = m_history[--hist_idx];
+        else
+          m_history[it - 1] = batch[--batch_idx];
+      }
+      /* debug check //{ */
+
+#ifdef REPREDICTOR_DEBUG
+      if (!checkMonotonicity(m_history))
+      {
+        std::cerr << "History buffer is not monotonous after modification!" << std::endl;
+      }
+      std::cerr << "Added " << batch.size() << " infos (" << m_history.size() << " total)" << std::endl;
+#endif
+
+      //}
+    }
+
+    /*!
+     * \brief Adds a batch of measurements to the history buffer, removing the oldest elements in the buffer if it is full.
+     *
+     * \param measurements  A range (eg. an std::vector) of the measurements to be added.
+     *
+     * \note This is the variant of the method when reprediction is disabled and will function like a dumb LKF.
+     *
+     */
+    template<typename Range, bool check=disable_reprediction>
+    std::enable_if_t<check> addMeasurements(const Range& measurements)
+    {
+      for (const auto& meas : measurements)
+        addMeasurement(meas.z, meas.R, meas.stamp, meas.model, meas.meas_id);
+    }
+    //}
+
+    /* getStatistics() method //{ */
+    /*!
+     * \brief Returns the statistics of the Repredictor usage (eg. for tuning the history buffer length).
+     *
+     * \return  Returns a snapshot of the counters, accumulated since the construction or since the last call of resetStatistics().
+     *
+     * \note This method is lock-free and may be called from a different thread than the other methods (eg. from a diagnostics timer).
+     * The individual counters are consistent, but the snapshot as a whole may be taken while the other thread is updating it.
+     *
+     */
+    statistics_t getStatistics() const
+    {
+      return m_stats.get();
+    }
+    //}
+
+    /* resetStatistics() method //{ */
+    /*!
+     * \brief Resets all counters of the statistics to zero.
+     *
+     * \note This method must not be called concurrently with the other (non-const) methods.
+     *
+     */
+    void resetStatistics()
+    {
+      m_stats.reset();
+    }
+    //}
+
+    /* setDelayHistogram() method //{ */
+    /*!
+     * \brief Changes the layout of the histogram of the measurement delays and resets it.
+     *
+     * By default, the histogram has 100 bins with a width of 10ms.
+     *
+     * \param bin_width  Width of one bin of the histogram.
+     * \param n_bins     Number of the bins (the last bin also contains all longer delays).
+     *
+     * \note This method must not be called concurrently with any other method, including getStatistics().
+     *
+     */
+    void setDelayHistogram(const ros::Duration& bin_width, const size_t n_bins)
+    {
+      assert(bin_width > ros::Duration(0) && n_bins > 0);
+      m_stats.setHistogram(bin_width.toSec(), n_bins);
     }
     //}
 
@@ -396,45 +665,185 @@ namespace mrs_lib
   private:
     /* helper structs and usings //{ */
 
-    struct info_t
-    {
-      ros::Time stamp;
+    // index of a model in the table of models (zero corresponds to the default model)
+    using model_idx_t = unsigned;
 
-      // system input-related information
+    // system input-related information
+    struct input_info_t
+    {
       u_t u;
       Q_t Q;
-      ModelPtr predict_model;
+      model_idx_t model;
+    };
 
-      // measurement-related information (unused in case is_measurement=false)
+    // measurement-related information
+    struct meas_info_t
+    {
       z_t z;
       R_t R;
-      ModelPtr correct_model;
-      bool is_measurement;
+      model_idx_t model;
       int meas_id;
+    };
+
+    // one point in the history buffer - either a system input or a measurement
+    struct info_t
+    {
+      ros::Time stamp;
+      std::variant<input_info_t, meas_info_t> data;
+
+      // cached posterior state and covariance at this history point (valid only if the point is in the updated part of the history)
+      statecov_t sc;
 
       // constructor for a dummy info (for searching in the history)
-      info_t(const ros::Time& stamp) : stamp(stamp), is_measurement(false){};
+      info_t(const ros::Time& stamp) : stamp(stamp){};
 
       // constructor for a system input
-      info_t(const ros::Time& stamp, const u_t& u, const Q_t& Q, const ModelPtr& model)
-          : stamp(stamp), u(u), Q(Q), predict_model(model), is_measurement(false){};
+      info_t(const ros::Time& stamp, const input_info_t& input) : stamp(stamp), data(input){};
 
       // constructor for a measurement
-      info_t(const ros::Time& stamp, const z_t& z, const R_t& R, const ModelPtr& model, const info_t& prev_info, const int& meas_id)
-          : stamp(stamp), z(z), R(R), correct_model(model), is_measurement(true), meas_id(meas_id)
+      info_t(const ros::Time& stamp, const meas_info_t& meas) : stamp(stamp), data(meas){};
+
+      bool is_measurement() const
       {
-        updateUsing(prev_info);
+        return std::holds_alternative<meas_info_t>(data);
       };
 
-      // copy system input-related information from a previous info
-      void updateUsing(const info_t& info)
+      const input_info_t& input() const
       {
-        u = info.u;
-        Q = info.Q;
-        predict_model = info.predict_model;
+        return *std::get_if<input_info_t>(&data);
+      };
+
+      const meas_info_t& meas() const
+      {
+        return *std::get_if<meas_info_t>(&data);
       };
     };
 
+    // counters of the statistics, which may be read from a different thread (the copies are snapshots, so that the Repredictor stays copyable)
+    class stats_counters_t
+    {
+    public:
+      stats_counters_t()
+      {
+        setHistogram(0.01, 100);
+      }
+
+      stats_counters_t(const stats_counters_t& other)
+      {
+        *this = other;
+      }
+
+      stats_counters_t& operator=(const stats_counters_t& other)
+      {
+        if (this == &other)
+          return *this;
+        const statistics_t stats = other.get();
+        setHistogram(stats.delay_bin_width, stats.delay_histogram.size());
+        store(m_n_measurements, stats.n_measurements);
+        store(m_n_out_of_sequence, stats.n_out_of_sequence);
+        store(m_n_dropped, stats.n_dropped);
+        store(m_max_delay, stats.max_delay);
+        for (size_t it = 0; it < m_n_bins; it++)
+          store(m_delay_histogram[it], stats.delay_histogram[it]);
+        store(m_n_predictions, stats.n_predictions);
+        store(m_n_replayed, stats.n_replayed);
+        store(m_max_replayed, stats.max_replayed);
+        store(m_replay_time, stats.replay_time);
+        store(m_max_replay_time, stats.max_replay_time);
+        return *this;
+      }
+
+      void setHistogram(const double bin_width, const size_t n_bins)
+      {
+        m_bin_width = bin_width;
+        m_n_bins = n_bins;
+        m_delay_histogram.reset(new std::atomic<uint64_t>[n_bins]());
+        reset();
+      }
+
+      void reset()
+      {
+        for (auto* counter : {&m_n_measurements, &m_n_out_of_sequence, &m_n_dropped, &m_n_predictions, &m_n_replayed, &m_max_replayed})
+          store(*counter, uint64_t(0));
+        for (auto* counter : {&m_max_delay, &m_replay_time, &m_max_replay_time})
+          store(*counter, 0.0);
+        for (size_t it = 0; it < m_n_bins; it++)
+          store(m_delay_histogram[it], uint64_t(0));
+      }
+
+      statistics_t get() const
+      {
+        statistics_t ret;
+        ret.n_measurements = load(m_n_measurements);
+        ret.n_out_of_sequence = load(m_n_out_of_sequence);
+        ret.n_dropped = load(m_n_dropped);
+        ret.max_delay = load(m_max_delay);
+        ret.delay_bin_width = m_bin_width;
+        ret.delay_histogram.reserve(m_n_bins);
+        for (size_t it = 0; it < m_n_bins; it++)
+          ret.delay_histogram.push_back(load(m_delay_histogram[it]));
+        ret.n_predictions = load(m_n_predictions);
+        ret.n_replayed = load(m_n_replayed);
+        ret.max_replayed = load(m_max_replayed);
+        ret.replay_time = load(m_replay_time);
+        ret.max_replay_time = load(m_max_replay_time);
+        return ret;
+      }
+
+      // the following methods are only called by the thread updating the Repredictor, so the atomic read-modify-write operations are not necessary
+      void addMeasurement(const double delay)
+      {
+        store(m_n_measurements, load(m_n_measurements) + 1);
+        if (delay > 0.0)
+          store(m_n_out_of_sequence, load(m_n_out_of_sequence) + 1);
+        if (delay > load(m_max_delay))
+          store(m_max_delay, delay);
+        const size_t bin = delay > 0.0 ? std::min(static_cast<size_t>(delay / m_bin_width), m_n_bins - 1) : 0;
+        store(m_delay_histogram[bin], load(m_delay_histogram[bin]) + 1);
+      }
+
+      void addDropped()
+      {
+        store(m_n_dropped, load(m_n_dropped) + 1);
+      }
+
+      void addReplay(const uint64_t n_replayed, const double replay_time)
+      {
+        store(m_n_predictions, load(m_n_predictions) + 1);
+        store(m_n_replayed, load(m_n_replayed) + n_replayed);
+        if (n_replayed > load(m_max_replayed))
+          store(m_max_replayed, n_replayed);
+        store(m_replay_time, load(m_replay_time) + replay_time);
+        if (replay_time > load(m_max_replay_time))
+          store(m_max_replay_time, replay_time);
+      }
+
+    private:
+      template <typename T>
+      static T load(const std::atomic<T>& counter)
+      {
+        return counter.load(std::memory_order_relaxed);
+      }
+
+      template <typename T>
+      static void store(std::atomic<T>& counter, const T value)
+      {
+        counter.store(value, std::memory_order_relaxed);
+      }
+
+      std::atomic<uint64_t> m_n_measurements;
+      std::atomic<uint64_t> m_n_out_of_sequence;
+      std::atomic<uint64_t> m_n_dropped;
+      std::atomic<double> m_max_delay;
+      double m_bin_width;
+      size_t m_n_bins;
+      std::unique_ptr<std::atomic<uint64_t>[]> m_delay_histogram;
+      std::atomic<uint64_t> m_n_predictions;
+      std::atomic<uint64_t> m_n_replayed;
+      std::atomic<uint64_t> m_max_replayed;
+      std::atomic<double> m_replay_time;
+      std::atomic<double> m_max_replay_time;
+    };
 
     //}
 
@@ -442,6 +851,16 @@ namespace mrs_lib
     using history_t = boost::circular_buffer<info_t>;
     // the history buffer
     history_t m_history;
+    // number of the oldest history points with an up-to-date cached posterior
+    size_t m_n_cached = 0;
+    // cached smoothed estimates of the newest history points (ordered from the newest)
+    std::vector<statecov_t> m_smoothed;
+    // system input-related information, valid at the oldest history point (the corresponding input may already be thrown out of the buffer)
+    input_info_t m_front_input;
+    // models, used by the history points (the first element is a placeholder for the default model)
+    std::vector<ModelPtr> m_models = {nullptr};
+    // statistics of the usage
+    stats_counters_t m_stats;
 
     // | ---------------- helper debugging methods ---------------- |
     /* checkMonotonicity() method //{ */
@@ -481,31 +900,54 @@ namespace mrs_lib
       // check if the new element would be added before the first element of the history buffer and ignore it if so
       if (next_it == std::begin(m_history) && !m_history.empty())
       {
+        m_stats.addDropped();
         ROS_WARN_STREAM_THROTTLE(1.0, "[Repredictor]: Added history point is older than the oldest by "
                                           << (next_it->stamp - info.stamp).toSec()
                                           << "s. Ignoring it! Consider increasing the history buffer size (currently: " << m_history.size() << ")");
         return std::end(m_history);
       }
 
+      // index of the new element in the history buffer (before the oldest one is possibly thrown out)
+      const size_t pos = next_it - std::begin(m_history);
       // check if adding a new element would throw out the oldest one
       if (m_history.size() == m_history.capacity())
-      {  // if so, first update m_sc
-        // figure out, what will be the oldest element in the buffer after inserting the newly received one
-        auto new_oldest = m_history.front();
-        if (m_history.size() == 1 || (m_history.size() > 1 && info.stamp > m_history.at(0).stamp && info.stamp < m_history.at(1).stamp))
+      {  // if so, first update m_sc to the posterior of the new oldest element (after inserting the new element)
+        if (pos == 1)
         {
-          new_oldest = info;
-        } else if (m_history.size() > 1)
+          // the newly received element will be the oldest one
+          const auto& oldest = updateCache(0);
+          m_sc = predictFrom(oldest.sc, inputAt(0), oldest.stamp, info.stamp);
+          if (info.is_measurement())
+          {
+            m_sc = correctFrom(m_sc, info.meas());
+            m_front_input = inputAt(0);
+          }
+          else
+          {
+            m_front_input = info.input();
+          }
+          m_n_cached = 0;
+        }
+        else
         {
-          new_oldest = m_history.at(1);
+          // the second oldest element will be the oldest one and its cached posterior stays valid
+          m_sc = updateCache(1).sc;
+          m_front_input = inputAt(1);
+          // the remaining cached posteriors are shifted by one after the oldest element is removed
+          m_n_cached = std::min(m_n_cached, pos) - 1;
         }
-        // update m_sc to the time of the new oldest element (after inserting the new element)
-        m_sc = predictTo(new_oldest.stamp);
         // insert the new element into the history buffer, causing the original oldest element to be removed
       }
+      else
+      {
+        // all cached posteriors from the new element onward are invalidated
+        m_n_cached = std::min(m_n_cached, pos);
+      }
 
       // add the new point finally
       const auto ret = m_history.insert(next_it, info);
+      // the smoothed estimates are affected by any new data
+      m_smoothed.clear();
       /* debug check //{ */
 
 #ifdef REPREDICTOR_DEBUG
@@ -528,22 +970,117 @@ namespace mrs_lib
     }
     //}
 
+    /* updateCache() method //{ */
+    // updates the cached posteriors up to the history point at index idx (inclusive) and returns this history point
+    info_t& updateCache(const size_t idx)
+    {
+      // the posterior of the oldest history point is always m_sc (the measurement is already included, if applicable)
+      if (m_n_cached == 0)
+      {
+        m_history.front().sc = m_sc;
+        m_history.front().sc.stamp = m_history.front().stamp;
+        m_n_cached = 1;
+      }
+      if (m_n_cached > idx)
+        return m_history[idx];
+      const input_info_t* inpt = &inputAt(m_n_cached - 1);
+      for (size_t it = m_n_cached; it <= idx; it++)
+      {
+        const info_t& prev = m_history[it - 1];
+        info_t& cur = m_history[it];
+        cur.sc = predictFrom(prev.sc, *inpt, prev.stamp, cur.stamp);
+        if (cur.is_measurement())
+          cur.sc = correctFrom(cur.sc, cur.meas());
+        else
+          inpt = &cur.input();
+        cur.sc.stamp = cur.stamp;
+      }
+      m_n_cached = idx + 1;
+      return m_history[idx];
+    }
+    //}
+
+    /* smoothBackward() method //{ */
+    // runs the backward pass of the smoother up to the history point at index idx (inclusive) and returns its smoothed estimate
+    const statecov_t& smoothBackward(const size_t idx)
+    {
+      // the smoothed estimate of the newest history point is its forward posterior
+      const info_t& newest = updateCache(m_history.size() - 1);
+      if (m_smoothed.empty())
+        m_smoothed.push_back(newest.sc);
+      // continue the backward pass from the oldest already smoothed history point
+      for (size_t it = m_history.size() - m_smoothed.size(); it > idx; it--)
+      {
+        const info_t& cur = m_history[it - 1];
+        statecov_t smoothed = rtsStep(cur.sc, inputAt(it - 1), cur.stamp, m_history[it].stamp, m_smoothed.back());
+        smoothed.stamp = cur.stamp;
+        m_smoothed.push_back(smoothed);
+      }
+      return m_smoothed[m_history.size() - 1 - idx];
+    }
+    //}
+
+    /* rtsStep() method //{ */
+    // one step of the Rauch-Tung-Striebel smoother from the posterior sc at from_stamp using the smoothed estimate at to_stamp
+    statecov_t rtsStep(const statecov_t& sc, const input_info_t& inpt, const ros::Time& from_stamp, const ros::Time& to_stamp, const statecov_t& smoothed_next)
+    {
+      const auto& model = getModel(inpt.model);
+      const auto dt = (to_stamp - from_stamp).toSec();
+      const statecov_t pred = model->predict(sc, inpt.u, inpt.Q, dt);
+      // the smoother gain C = P*A^T*P_pred^-1 (calculated using the symmetry of the covariance matrices)
+      const P_t C = pred.P.ldlt().solve(model->getA(dt) * sc.P).transpose();
+      statecov_t ret;
+      ret.x = sc.x + C * (smoothed_next.x - pred.x);
+      ret.P = sc.P + C * (smoothed_next.P - pred.P) * C.transpose();
+      return ret;
+    }
+    //}
+
+    /* inputAt() method //{ */
+    // returns the system input-related information, valid at the history point at index idx
+    const input_info_t& inputAt(const size_t idx) const
+    {
+      // find the last system input up to this history point
+      for (size_t it = idx + 1; it > 0; it--)
+        if (!m_history[it - 1].is_measurement())
+          return m_history[it - 1].input();
+      return m_front_input;
+    }
+    //}
+
+    /* modelIndex() method //{ */
+    // returns the index of the model in the table of models, adding it to the table if necessary
+    model_idx_t modelIndex(const ModelPtr& model)
+    {
+      if (model == nullptr || model == m_default_model)
+        return 0;
+      for (model_idx_t it = 1; it < m_models.size(); it++)
+        if (m_models[it] == model)
+          return it;
+      m_models.push_back(model);
+      return m_models.size() - 1;
+    }
+    //}
+
+    /* getModel() method //{ */
+    const ModelPtr& getModel(const model_idx_t idx) const
+    {
+      return idx == 0 ? m_default_model : m_models[idx];
+    }
+    //}
+
     /* predictFrom() method //{ */
-    statecov_t predictFrom(const statecov_t& sc, const info_t& inpt, const ros::Time& from_stamp, const ros::Time& to_stamp)
+    statecov_t predictFrom(const statecov_t& sc, const input_info_t& inpt, const ros::Time& from_stamp, const ros::Time& to_stamp) const
     {
-      const auto model = inpt.predict_model == nullptr ? m_default_model : inpt.predict_model;
       const auto dt = (to_stamp - from_stamp).toSec();
-      return model->predict(sc, inpt.u, inpt.Q, dt);
+      return getModel(inpt.model)->predict(sc, inpt.u, inpt.Q, dt);
     }
     //}
 
     /* correctFrom() method //{ */
-    statecov_t correctFrom(const statecov_t& sc, const info_t& meas)
+    statecov_t correctFrom(const statecov_t& sc, const meas_info_t& meas) const
     {
-      assert(meas.is_measurement);
-      const auto model = meas.correct_model == nullptr ? m_default_model : meas.correct_model;
-      auto sc_tmp = sc;
-      return model->correct(sc_tmp, meas.z, meas.R);
+      return getModel(meas.model)->correct(sc, meas.z, meas.R);
     }
     //}
   };
@@ -8,6 +8,7 @@
 #include <ros/ros.h>
 #include <mrs_lib/utils.h>
 #include <mrs_lib/repredictor.h>
+#include <mrs_lib/kalman_filter_aloamgarm.h>
 
 namespace mrs_lib
 {
@@ -67,17 +68,46 @@ public:
    * \param t0             Time stamp of the initial state.
    * \param model          Default prediction and correction model.
    * \param hist_len       Length of the history buffer for system inputs and measurements.
-   * \param nis_buffer     Circular buffer for NIS values.
+   * \param nis_buffer     Sliding window for NIS values.
    */
   RepredictorAloamgarm(const x_t& x0, const P_t& P0, const u_t& u0, const Q_t& Q0, const ros::Time& t0, const ModelPtr& model, const unsigned hist_len,
-                       const std::shared_ptr<boost::circular_buffer<double>>& nis_buffer) {
+                       const std::shared_ptr<NisBuffer>& nis_buffer) {
     Repredictor<Model>::m_sc            = {x0, P0, nis_buffer};
     Repredictor<Model>::m_default_model = model;
     Repredictor<Model>::m_history       = history_t(hist_len);
     assert(hist_len > 0);
     Repredictor<Model>::addInputChangeWithNoise(u0, Q0, t0, model);
   };
+
+  /*!
+   * \brief Variation of the constructor for kalman filter using nis_buffer (ALOAMGARM), kept for backwards compatibility.
+   *
+   * The values from \p nis_buffer are copied to a new NisBuffer of the same capacity, which is then used instead.
+   *
+   * \param x0             Initial state.
+   * \param P0             Covariance matrix of the initial state uncertainty.
+   * \param u0             Initial system input.
+   * \param Q0             Default covariance matrix of the process noise.
+   * \param t0             Time stamp of the initial state.
+   * \param model          Default prediction and correction model.
+   * \param hist_len       Length of the history buffer for system inputs and measurements.
+   * \param nis_buffer     Circular buffer for NIS values.
+   */
+  RepredictorAloamgarm(const x_t& x0, const P_t& P0, const u_t& u0, const Q_t& Q0, const ros::Time& t0, const ModelPtr& model, const unsigned hist_len,
+                       const std::shared_ptr<boost::circular_buffer<double>>& nis_buffer)
+      : RepredictorAloamgarm(x0, P0, u0, Q0, t0, model, hist_len, toNisBuffer(nis_buffer)) {};
   //}
+
+private:
+  static std::shared_ptr<NisBuffer> toNisBuffer(const std::shared_ptr<boost::circular_buffer<double>>& buffer)
+  {
+    if (buffer == nullptr)
+      return nullptr;
+    auto ret = std::make_shared<NisBuffer>(buffer->capacity());
+    for (const double val : *buffer)
+      ret->push_back(val);
+    return ret;
+  }
 };
 }  // namespace mrs_lib
 
@@ -0,0 +1,291 @@
+// clang: MatousFormat
+/**  \file
+     \brief Defines RepredictorConcurrent - a thread-safe variant of the Repredictor with lock-free insertion of new data.
+ */
+#ifndef REPREDICTOR_CONCURRENT_H
+#define REPREDICTOR_CONCURRENT_H
+
+#include <mrs_lib/repredictor.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace mrs_lib
+{
+  /**
+   * \brief Thread-safe variant of the Repredictor with lock-free insertion of system inputs and measurements.
+   *
+   * The Repredictor itself has no internal synchronization, so all calls of its methods have to be serialized by the user.
+   * This variant enables calling the addInputChangeWithNoise(), addInputChange(), addProcessNoiseChange() and addMeasurement()
+   * methods concurrently from multiple threads (eg. from several subscriber callbacks) without blocking. The new data is
+   * only pushed to a lock-free queue by these methods and it is merged into the history buffer in a batch when
+   * predictTo() or processQueue() is called. These two methods are serialized using an internal mutex, so the filter
+   * math is only ever executed by the thread requesting the prediction.
+   *
+   * The data from the queue are merged in the order in which they were added, so the result is the same as if
+   * the corresponding methods of the Repredictor were called sequentially in this order. Consecutive measurements
+   * are merged at once using the Repredictor::addMeasurements() method.
+   *
+   * \tparam Model  the prediction and correction model (eg. a Kalman Filter).
+   *
+   */
+  template <class Model>
+  class RepredictorConcurrent : public Repredictor<Model>
+  {
+  public:
+    /* states, inputs etc. definitions (typedefs, constants etc) //{ */
+
+    using Base_class = Repredictor<Model>;              /*!< \brief Base class of this class. */
+    using x_t = typename Base_class::x_t;               /*!< \brief State vector type \f$n \times 1\f$ */
+    using u_t = typename Base_class::u_t;               /*!< \brief Input vector type \f$m \times 1\f$ */
+    using z_t = typename Base_class::z_t;               /*!< \brief Measurement vector type \f$p \times 1\f$ */
+    using P_t = typename Base_class::P_t;               /*!< \brief State uncertainty covariance matrix type \f$n \times n\f$ */
+    using R_t = typename Base_class::R_t;               /*!< \brief Measurement noise covariance matrix type \f$p \times p\f$ */
+    using Q_t = typename Base_class::Q_t;               /*!< \brief Process noise covariance matrix type \f$n \times n\f$ */
+    using statecov_t = typename Base_class::statecov_t; /*!< \brief Helper struct for passing around the state and its covariance in one variable */
+    using ModelPtr = typename Base_class::ModelPtr;     /*!< \brief Shorthand type for a shared pointer-to-Model */
+    using measurement_t = typename Base_class::measurement_t; /*!< \brief Helper struct for passing a measurement to the addMeasurements() method */
+
+    //}
+
+    // the constructors are the same as for the Repredictor (no other thread may use the object during construction anyways)
+    using Base_class::Base_class;
+
+    /* destructor //{ */
+    ~RepredictorConcurrent()
+    {
+      // delete any data remaining in the queue
+      node_t* node = m_queue_head.exchange(nullptr, std::memory_order_acquire);
+      while (node != nullptr)
+      {
+        node_t* const next = node->next;
+        delete node;
+        node = next;
+      }
+    }
+    //}
+
+    /* predictTo() method //{ */
+    /*!
+     * \brief Estimates the system state and covariance matrix at the specified time.
+     *
+     * All data waiting in the queue are first merged into the history buffer, which is then used to estimate
+     * the state vector and covariance matrix values at the specified time, which are returned.
+     *
+     * \param to_stamp   The desired time at which the state vector and covariance matrix should be estimated.
+     * \return           Returns the estimated state vector and covariance matrix in a single struct.
+     *
+     * \note This method is thread-safe, but it may block while another thread is calling predictTo() or processQueue().
+     *
+     */
+    statecov_t predictTo(const ros::Time& to_stamp)
+    {
+      std::scoped_lock lck(m_mtx);
+      processQueueUnsafe();
+      return Base_class::predictTo(to_stamp);
+    }
+    //}
+
+    /* processQueue() method //{ */
+    /*!
+     * \brief Merges all data waiting in the queue into the history buffer.
+     *
+     * This is done automatically when calling predictTo(), so you usually don't need to call this method.
+     *
+     * \note This method is thread-safe, but it may block while another thread is calling predictTo() or processQueue().
+     *
+     */
+    void processQueue()
+    {
+      std::scoped_lock lck(m_mtx);
+      processQueueUnsafe();
+    }
+    //}
+
+    /* addInputChangeWithNoise() method //{ */
+    /*!
+     * \brief Adds one system input to the queue of data, which will be merged into the history buffer during the next call of predictTo().
+     *
+     * \param u      The system input vector to be added.
+     * \param Q      The process noise covariance matrix.
+     * \param stamp  Time stamp of the input vector and covariance matrix.
+     * \param model  Optional pointer to a specific Model to be used with this input (eg. mapping it to different states). If it equals to nullptr, the default
+     * model specified in the constructor will be used.
+     *
+     * \note This method is thread-safe and lock-free.
+     *
+     */
+    void addInputChangeWithNoise(const u_t& u, const Q_t& Q, const ros::Time& stamp, const ModelPtr& model = nullptr)
+    {
+      node_t* const node = new node_t(data_type_t::input_with_noise, stamp, model);
+      node->u = u;
+      node->Q = Q;
+      push(node);
+    }
+    //}
+
+    /* addInputChange() method //{ */
+    /*!
+     * \brief Adds one system input to the queue of data, which will be merged into the history buffer during the next call of predictTo().
+     *
+     * \param u      The system input vector to be added.
+     * \param stamp  Time stamp of the input vector and covariance matrix.
+     * \param model  Optional pointer to a specific Model to be used with this input (eg. mapping it to different states). If it equals to nullptr, the default
+     * model specified in the constructor will be used.
+     *
+     * \note This method is thread-safe and lock-free.
+     *
+     */
+    void addInputChange(const u_t& u, const ros::Time& stamp, const ModelPtr& model = nullptr)
+    {
+      node_t* const node = new node_t(data_type_t::input, stamp, model);
+      node->u = u;
+      push(node);
+    }
+    //}
+
+    /* addProcessNoiseChange() method //{ */
+    /*!
+     * \brief Adds one process noise covariance to the queue of data, which will be merged into the history buffer during the next call of predictTo().
+     *
+     * \param Q      The process noise covariance matrix.
+     * \param stamp  Time stamp of the input vector and covariance matrix.
+     * \param model  Optional pointer to a specific Model to be used with this covariance matrix (eg. mapping it to different states). If it equals to nullptr,
+     * the default model specified in the constructor will be used.
+     *
+     * \note This method is thread-safe and lock-free.
+     *
+     */
+    void addProcessNoiseChange(const Q_t& Q, const ros::Time& stamp, const ModelPtr& model = nullptr)
+    {
+      node_t* const node = new node_t(data_type_t::process_noise, stamp, model);
+      node->Q = Q;
+      push(node);
+    }
+    //}
+
+    /* addMeasurement() method //{ */
+    /*!
+     * \brief Adds one measurement to the queue of data, which will be merged into the history buffer during the next call of predictTo().
+     *
+     * \param z      The measurement vector to be added.
+     * \param R      The measurement noise covariance matrix, corresponding to the measurement vector.
+     * \param stamp  Time stamp of the measurement vector and covariance matrix.
+     * \param model  Optional pointer to a specific Model to be used with this measurement (eg. mapping it from different states). If it equals to nullptr, the
+     * default model specified in the constructor will be used.
+     * \param meas_id  Optional identifier of the measurement.
+     *
+     * \note This method is thread-safe and lock-free.
+     *
+     */
+    void addMeasurement(const z_t& z, const R_t& R, const ros::Time& stamp, const ModelPtr& model = nullptr, const double& meas_id = -1)
+    {
+      node_t* const node = new node_t(data_type_t::measurement, stamp, model);
+      node->z = z;
+      node->R = R;
+      node->meas_id = meas_id;
+      push(node);
+    }
+    //}
+
+  private:
+    /* helper structs and usings //{ */
+
+    enum class data_type_t
+    {
+      input_with_noise,
+      input,
+      process_noise,
+      measurement,
+    };
+
+    // one element of the singly-linked list, used as the queue
+    struct node_t
+    {
+      data_type_t type;
+      ros::Time stamp;
+      ModelPtr model;
+
+      u_t u;
+      Q_t Q;
+      z_t z;
+      R_t R;
+      double meas_id;
+
+      node_t* next = nullptr;
+
+      node_t(const data_type_t type, const ros::Time& stamp, const ModelPtr& model) : type(type), stamp(stamp), model(model){};
+    };
+
+    //}
+
+  private:
+    // the newest element in the queue (the elements are linked from the newest to the oldest)
+    std::atomic<node_t*> m_queue_head = nullptr;
+    // serializes access to the history buffer and the filter itself
+    std::mutex m_mtx;
+
+  private:
+    /* push() method //{ */
+    // the only operation done by the producers - a lock-free push to the head of the list
+    void push(node_t* const node)
+    {
+      node->next = m_queue_head.load(std::memory_order_relaxed);
+      while (!m_queue_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+        ;
+    }
+    //}
+
+    /* processQueueUnsafe() method //{ */
+    // takes the whole queue at once and merges it into the history buffer (m_mtx has to be locked when calling this method)
+    void processQueueUnsafe()
+    {
+      node_t* node = m_queue_head.exchange(nullptr, std::memory_order_acquire);
+
+      // reverse the list so that the data are processed in the order in which they were added
+      node_t* oldest = nullptr;
+      while (node != nullptr)
+      {
+        node_t* const next = node->next;
+        node->next = oldest;
+        oldest = node;
+        node = next;
+      }
+
+      // consecutive measurements are merged into the history buffer in a single batch
+      std::vector<measurement_t> meass;
+      node = oldest;
+      while (node != nullptr)
+      {
+        if (node->type != data_type_t::measurement && !meass.empty())
+        {
+          Base_class::addMeasurements(meass);
+          meass.clear();
+        }
+        switch (node->type)
+        {
+          case data_type_t::input_with_noise:
+            Base_class::addInputChangeWithNoise(node->u, node->Q, node->stamp, node->model);
+            break;
+          case data_type_t::input:
+            Base_class::addInputChange(node->u, node->stamp, node->model);
+            break;
+          case data_type_t::process_noise:
+            Base_class::addProcessNoiseChange(node->Q, node->stamp, node->model);
+            break;
+          case data_type_t::measurement:
+            meass.push_back({node->z, node->R, node->stamp, node->model, static_cast<int>(node->meas_id)});
+            break;
+        }
+        node_t* const next = node->next;
+        delete node;
+        node = next;
+      }
+      if (!meass.empty())
+        Base_class::addMeasurements(meass);
+    }
+    //}
+  };
+}  // namespace mrs_lib
+
+#endif  // REPREDICTOR_CONCURRENT_H
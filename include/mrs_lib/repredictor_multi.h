@@ -0,0 +1,425 @@
+// clang: MatousFormat
+/**  \file
+     \brief Defines RepredictorMulti - a variant of the Repredictor with multiple measurement models, selected at compile time.
+ */
+#ifndef REPREDICTOR_MULTI_H
+#define REPREDICTOR_MULTI_H
+
+#include <Eigen/Dense>
+#include <boost/circular_buffer.hpp>
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <ros/ros.h>
+
+namespace mrs_lib
+{
+  /**
+   * \brief Variant of the Repredictor for fusing measurements of different dimensions from several sensors.
+   *
+   * The Repredictor uses a single Model, which also fixes the type of the measurement vector and of its covariance matrix, and
+   * the models of individual measurements are passed at runtime and dispatched using virtual calls. This variant is instead parametrized
+   * by a list of measurement models (eg. LKFs with different measurement matrices and different numbers of measurements), which are
+   * selected at compile time using the index of the model in the list (see the addMeasurement() method). Each measurement in the history
+   * buffer keeps its own fixed-size measurement vector and covariance matrix (eg. 3D for GPS and 1D for a barometer) without padding
+   * it to the largest dimension or using dynamic-size matrices, and the predict() and correct() methods of the models are called without
+   * virtual dispatch.
+   *
+   * Apart from that, the RepredictorMulti works the same way as the Repredictor (including caching of the posteriors in the history buffer),
+   * see its documentation for details.
+   *
+   * \note The predict() and correct() methods of the exact Model and MeasModels types are called, so the objects passed to the constructor
+   * must not be of a type derived from these (use the final type as the template parameter instead).
+   *
+   * \tparam Model       the prediction model (eg. a Kalman Filter), which has to implement the predict() method.
+   * \tparam MeasModels  the correction models (eg. Kalman Filters), which have to implement the correct() method and have the same state vector as Model.
+   *
+   */
+  template <class Model, class... MeasModels>
+  class RepredictorMulti
+  {
+  public:
+    /* states, inputs etc. definitions (typedefs, constants etc) //{ */
+
+    using x_t = typename Model::x_t;                  /*!< \brief State vector type \f$n \times 1\f$ */
+    using u_t = typename Model::u_t;                  /*!< \brief Input vector type \f$m \times 1\f$ */
+    using P_t = typename Model::P_t;                  /*!< \brief State uncertainty covariance matrix type \f$n \times n\f$ */
+    using Q_t = typename Model::Q_t;                  /*!< \brief Process noise covariance matrix type \f$n \times n\f$ */
+    using statecov_t = typename Model::statecov_t;    /*!< \brief Helper struct for passing around the state and its covariance in one variable */
+    using ModelPtr = typename std::shared_ptr<Model>; /*!< \brief Shorthand type for a shared pointer-to-Model */
+
+    static constexpr size_t n_meas_models = sizeof...(MeasModels); /*!< \brief Number of the measurement models. */
+
+    template <size_t I>
+    using meas_model_t = std::tuple_element_t<I, std::tuple<MeasModels...>>; /*!< \brief Type of the I-th measurement model */
+    template <size_t I>
+    using z_t = typename meas_model_t<I>::z_t; /*!< \brief Measurement vector type of the I-th measurement model \f$p_I \times 1\f$ */
+    template <size_t I>
+    using R_t = typename meas_model_t<I>::R_t; /*!< \brief Measurement noise covariance matrix type of the I-th measurement model \f$p_I \times p_I\f$ */
+
+    static_assert(n_meas_models > 0, "RepredictorMulti: at least one measurement model has to be specified");
+    static_assert(((MeasModels::n == Model::n) && ...), "RepredictorMulti: all measurement models must have the same number of states as the prediction model");
+
+    //}
+
+    /* predictTo() method //{ */
+    /*!
+     * \brief Estimates the system state and covariance matrix at the specified time.
+     *
+     * The measurement and system input histories are used to estimate the state vector and
+     * covariance matrix values at the specified time, which are returned.
+     *
+     * \param to_stamp   The desired time at which the state vector and covariance matrix should be estimated.
+     * \return           Returns the estimated state vector and covariance matrix in a single struct.
+     *
+     */
+    statecov_t predictTo(const ros::Time& to_stamp)
+    {
+      assert(!m_history.empty());
+      // find the last history point, which is not newer than the desired stamp (or the first one if all are newer)
+      const auto next_it = std::upper_bound(std::begin(m_history), std::end(m_history), to_stamp, &RepredictorMulti::earlier);
+      const size_t idx = next_it == std::begin(m_history) ? 0 : next_it - std::begin(m_history) - 1;
+      // make sure that the cached posteriors are up to date up to this history point
+      const auto& info = updateCache(idx);
+      // predict from the cached posterior straight to the desired stamp
+      auto cur_sc = predictFrom(info.sc, inputAt(idx), info.stamp, to_stamp);
+      cur_sc.stamp = to_stamp;
+      return cur_sc;
+    }
+    //}
+
+    /* addInputChangeWithNoise() method //{ */
+    /*!
+     * \brief Adds one system input to the history buffer, removing the oldest element in the buffer if it is full.
+     *
+     * \param u      The system input vector to be added.
+     * \param Q      The process noise covariance matrix.
+     * \param stamp  Time stamp of the input vector and covariance matrix.
+     *
+     * \note The system input vector will not be added if it is older than the oldest element in the history buffer.
+     *
+     */
+    void addInputChangeWithNoise(const u_t& u, const Q_t& Q, const ros::Time& stamp)
+    {
+      addInfo(info_t(stamp, input_info_t{u, Q}));
+    }
+    //}
+
+    /* addInputChange() method //{ */
+    /*!
+     * \brief Adds one system input to the history buffer, removing the oldest element in the buffer if it is full.
+     *
+     * The process noise covariance matrix, valid at the time of the new system input, is kept.
+     *
+     * \param u      The system input vector to be added.
+     * \param stamp  Time stamp of the input vector.
+     *
+     * \note The system input vector will not be added if it is older than the oldest element in the history buffer.
+     *
+     */
+    void addInputChange(const u_t& u, const ros::Time& stamp)
+    {
+      addInfo(info_t(stamp, input_info_t{u, inputAt(prevIndex(stamp)).Q}));
+    }
+    //}
+
+    /* addProcessNoiseChange() method //{ */
+    /*!
+     * \brief Adds one process noise covariance matrix to the history buffer, removing the oldest element in the buffer if it is full.
+     *
+     * The system input vector, valid at the time of the new covariance matrix, is kept.
+     *
+     * \param Q      The process noise covariance matrix.
+     * \param stamp  Time stamp of the covariance matrix.
+     *
+     * \note The covariance matrix will not be added if it is older than the oldest element in the history buffer.
+     *
+     */
+    void addProcessNoiseChange(const Q_t& Q, const ros::Time& stamp)
+    {
+      addInfo(info_t(stamp, input_info_t{inputAt(prevIndex(stamp)).u, Q}));
+    }
+    //}
+
+    /* addMeasurement() method //{ */
+    /*!
+     * \brief Adds one measurement to the history buffer, removing the oldest element in the buffer if it is full.
+     *
+     * \tparam I     Index of the measurement model (in the MeasModels list), which will be used for this measurement.
+     *
+     * \param z      The measurement vector to be added.
+     * \param R      The measurement noise covariance matrix, corresponding to the measurement vector.
+     * \param stamp  Time stamp of the measurement vector and covariance matrix.
+     *
+     * \note The measurement will not be added if it is older than the oldest element in the history buffer.
+     *
+     */
+    template <size_t I>
+    void addMeasurement(const z_t<I>& z, const R_t<I>& R, const ros::Time& stamp)
+    {
+      static_assert(I < n_meas_models, "RepredictorMulti: index of the measurement model is out of range");
+      addInfo(info_t(stamp, data_t(std::in_place_index<I + 1>, meas_info_t<I>{z, R})));
+    }
+    //}
+
+  public:
+    /* constructor //{ */
+
+    /*!
+     * \brief The main constructor.
+     *
+     * Initializes the RepredictorMulti with the necessary initial and default values.
+     *
+     * \param x0             Initial state.
+     * \param P0             Covariance matrix of the initial state uncertainty.
+     * \param u0             Initial system input.
+     * \param Q0             Default covariance matrix of the process noise.
+     * \param t0             Time stamp of the initial state.
+     * \param model          The prediction model.
+     * \param meas_models    The measurement models (in the same order as in the MeasModels list).
+     * \param hist_len       Length of the history buffer for system inputs and measurements.
+     */
+    RepredictorMulti(const x_t& x0, const P_t& P0, const u_t& u0, const Q_t& Q0, const ros::Time& t0, const ModelPtr& model,
+                     const std::tuple<std::shared_ptr<MeasModels>...>& meas_models, const unsigned hist_len)
+        : m_sc{x0, P0}, m_model(model), m_meas_models(meas_models), m_history(history_t(hist_len))
+    {
+      assert(hist_len > 0);
+      addInputChangeWithNoise(u0, Q0, t0);
+    };
+
+    //}
+
+  private:
+    /* helper structs and usings //{ */
+
+    // system input-related information
+    struct input_info_t
+    {
+      u_t u;
+      Q_t Q;
+    };
+
+    // measurement-related information for the I-th measurement model
+    template <size_t I>
+    struct meas_info_t
+    {
+      z_t<I> z;
+      R_t<I> R;
+    };
+
+    // the first alternative is a system input, the I+1-th alternative is a measurement for the I-th measurement model
+    template <size_t... Is>
+    static std::variant<input_info_t, meas_info_t<Is>...> make_data_t(std::index_sequence<Is...>);
+    using data_t = decltype(make_data_t(std::index_sequence_for<MeasModels...>{}));
+
+    // one point in the history buffer - either a system input or a measurement
+    struct info_t
+    {
+      ros::Time stamp;
+      data_t data;
+
+      // cached posterior state and covariance at this history point (valid only if the point is in the updated part of the history)
+      statecov_t sc;
+
+      // constructor for a dummy info (for searching in the history)
+      info_t(const ros::Time& stamp) : stamp(stamp){};
+
+      info_t(const ros::Time& stamp, const data_t& data) : stamp(stamp), data(data){};
+
+      bool is_measurement() const
+      {
+        return data.index() != 0;
+      };
+
+      const input_info_t& input() const
+      {
+        return *std::get_if<0>(&data);
+      };
+    };
+
+    using history_t = boost::circular_buffer<info_t>;
+
+    //}
+
+  private:
+    // state and covariance corresponding to the oldest element in the history buffer
+    statecov_t m_sc;
+    // the prediction model
+    ModelPtr m_model;
+    // the measurement models
+    std::tuple<std::shared_ptr<MeasModels>...> m_meas_models;
+    // the history buffer
+    history_t m_history;
+    // number of the oldest history points with a valid cached posterior
+    size_t m_n_cached = 0;
+    // system input-related information, valid at the oldest history point (the corresponding input may already be thrown out of the buffer)
+    input_info_t m_front_input;
+
+  private:
+    /* earlier() method //{ */
+    static bool earlier(const info_t& ia, const info_t& ib)
+    {
+      return ia.stamp < ib.stamp;
+    }
+    //}
+
+    /* prevIndex() method //{ */
+    // returns the index of the last history point older than the stamp (or zero if there is none)
+    size_t prevIndex(const ros::Time& stamp) const
+    {
+      const auto next_it = std::lower_bound(std::begin(m_history), std::end(m_history), stamp, &RepredictorMulti::earlier);
+      return next_it == std::begin(m_history) ? 0 : next_it - std::begin(m_history) - 1;
+    }
+    //}
+
+    /* addInfo() method //{ */
+    void addInfo(const info_t& info)
+    {
+      // find the next point in the history buffer
+      const auto next_it = std::lower_bound(std::begin(m_history), std::end(m_history), info, &RepredictorMulti::earlier);
+
+      // check if the new element would be added before the first element of the history buffer and ignore it if so
+      if (next_it == std::begin(m_history) && !m_history.empty())
+      {
+        ROS_WARN_STREAM_THROTTLE(1.0, "[RepredictorMulti]: Added history point is older than the oldest by "
+                                          << (next_it->stamp - info.stamp).toSec()
+                                          << "s. Ignoring it! Consider increasing the history buffer size (currently: " << m_history.size() << ")");
+        return;
+      }
+
+      // index of the new element in the history buffer (before the oldest one is possibly thrown out)
+      const size_t pos = next_it - std::begin(m_history);
+      // check if adding a new element would throw out the oldest one
+      if (m_history.size() == m_history.capacity())
+      {  // if so, first update m_sc to the posterior of the new oldest element (after inserting the new element)
+        if (pos == 1)
+        {
+          // the newly received element will be the oldest one
+          const auto& oldest = updateCache(0);
+          m_sc = predictFrom(oldest.sc, inputAt(0), oldest.stamp, info.stamp);
+          if (info.is_measurement())
+          {
+            m_sc = correctFrom(m_sc, info.data);
+            m_front_input = inputAt(0);
+          }
+          else
+          {
+            m_front_input = info.input();
+          }
+          m_n_cached = 0;
+        }
+        else
+        {
+          // the second oldest element will be the oldest one and its cached posterior stays valid
+          m_sc = updateCache(1).sc;
+          m_front_input = inputAt(1);
+          // the remaining cached posteriors are shifted by one after the oldest element is removed
+          m_n_cached = std::min(m_n_cached, pos) - 1;
+        }
+      }
+      else
+      {
+        // all cached posteriors from the new element onward are invalidated
+        m_n_cached = std::min(m_n_cached, pos);
+      }
+
+      // add the new point finally (causing the original oldest element to be removed if the buffer is full)
+      m_history.insert(next_it, info);
+    }
+    //}
+
+    /* updateCache() method //{ */
+    // makes sure that the cached posteriors are valid up to the history point at index idx (including) and returns this point
+    const info_t& updateCache(const size_t idx)
+    {
+      if (m_n_cached == 0)
+      {
+        info_t& front = m_history.front();
+        front.sc = m_sc;
+        front.sc.stamp = front.stamp;
+        m_n_cached = 1;
+      }
+      if (m_n_cached > idx)
+        return m_history[idx];
+      const input_info_t* inpt = &inputAt(m_n_cached - 1);
+      for (size_t it = m_n_cached; it <= idx; it++)
+      {
+        const info_t& prev = m_history[it - 1];
+        info_t& cur = m_history[it];
+        cur.sc = predictFrom(prev.sc, *inpt, prev.stamp, cur.stamp);
+        if (cur.is_measurement())
+          cur.sc = correctFrom(cur.sc, cur.data);
+        else
+          inpt = &cur.input();
+        cur.sc.stamp = cur.stamp;
+      }
+      m_n_cached = idx + 1;
+      return m_history[idx];
+    }
+    //}
+
+    /* inputAt() method //{ */
+    // returns the system input-related information, valid at the history point at index idx
+    const input_info_t& inputAt(const size_t idx) const
+    {
+      // find the last system input up to this history point
+      for (size_t it = idx + 1; it > 0; it--)
+        if (!m_history[it - 1].is_measurement())
+          return m_history[it - 1].input();
+      return m_front_input;
+    }
+    //}
+
+    /* predictFrom() method //{ */
+    statecov_t predictFrom(const statecov_t& sc, const input_info_t& inpt, const ros::Time& from_stamp, const ros::Time& to_stamp) const
+    {
+      const auto dt = (to_stamp - from_stamp).toSec();
+      // the qualified call avoids the virtual dispatch
+      return m_model->Model::predict(sc, inpt.u, inpt.Q, dt);
+    }
+    //}
+
+    /* correctFrom() method //{ */
+    // corrects the state using the measurement model, corresponding to the type of the measurement
+    statecov_t correctFrom(const statecov_t& sc, const data_t& data) const
+    {
+      return correctFrom(sc, data, std::index_sequence_for<MeasModels...>{});
+    }
+
+    template <size_t... Is>
+    statecov_t correctFrom(const statecov_t& sc, const data_t& data, std::index_sequence<Is...>) const
+    {
+      statecov_t ret = sc;
+      // only the measurement model with an index matching the measurement will be used
+      ((data.index() == Is + 1 && (ret = correctUsing<Is>(sc, *std::get_if<Is + 1>(&data)), true)) || ...);
+      return ret;
+    }
+
+    template <size_t I>
+    statecov_t correctUsing(const statecov_t& sc, const meas_info_t<I>& meas) const
+    {
+      using MeasModel = meas_model_t<I>;
+      using meas_model_statecov_t = typename MeasModel::statecov_t;
+      const auto& model = std::get<I>(m_meas_models);
+      // the qualified call avoids the virtual dispatch
+      if constexpr (std::is_same_v<statecov_t, meas_model_statecov_t>)
+      {
+        return model->MeasModel::correct(sc, meas.z, meas.R);
+      }
+      else
+      {
+        // the measurement models may use a different type of the state (eg. because of a different number of measurements)
+        const auto corrected = model->MeasModel::correct(meas_model_statecov_t{sc.x, sc.P, sc.stamp}, meas.z, meas.R);
+        statecov_t ret = sc;
+        ret.x = corrected.x;
+        ret.P = corrected.P;
+        return ret;
+      }
+    }
+    //}
+  };
+}  // namespace mrs_lib
+
+#endif  // REPREDICTOR_MULTI_H
@@ -8,8 +8,20 @@
 #define HEIV_H
 
 #include <Eigen/Dense>
+#include <Eigen/StdVector>
+#include <mrs_lib/impl/parallel_for.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <iostream>
 #include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <tuple>
+#include <vector>
 
 namespace mrs_lib
 {
@@ -85,10 +97,21 @@ namespace mrs_lib
     using theta_t = Eigen::Matrix<double, l, 1>;            /*!< \brief Parameter vector type \f$l \times 1\f$ */
     using eta_t = z_t;                                      /*!< \brief Reduced parameter vector type \f$l_r \times 1\f$ */
 
-  private:
+    /*!
+      * \brief Parameters of the robust fitting using the fit_RANSAC() method.
+      */
+    struct ransac_params_t
+    {
+      double inlier_threshold = 9.0;    /*!< \brief Threshold of the normalized squared residual of an inlier (the default corresponds to three standard deviations). */
+      double confidence = 0.99;         /*!< \brief Required probability that at least one of the hypotheses was generated from inliers only. */
+      unsigned max_hypotheses = 1000;   /*!< \brief Maximal number of the generated hypotheses. */
+      unsigned seed = 0;                /*!< \brief Seed of the random generator, used for drawing the minimal samples (the fit is repeatable for the same seed). */
+    };
+
+  protected:
     using A_t = Eigen::Matrix<double, lr, lr>;          /*!< \brief Type of the helper matrix \f$m \mathbf{A} 1\f$, \f$l_r \times l_r\f$ */
     using B_t = A_t;                                    /*!< \brief Type of the helper matrix \f$m \mathbf{B} 1\f$, \f$l_r \times l_r\f$ */
-    using Bs_t = std::vector<B_t>;                      /*!< \brief Container type for an array of matrices \p B, corresponding to the input data */
+    using Bs_t = Eigen::Matrix<double, lr*lr, -1>;      /*!< \brief Container type for an array of matrices \p B, corresponding to the input data (each column is one matrix in the column-major order) */
     using M_t = A_t;                                    /*!< \brief Type of the matrix \f$m \mathbf{M} 1\f$, used in the generalized eigen vector problem, \f$l_r \times l_r\f$ */
     using N_t = A_t;                                    /*!< \brief Type of the matrix \f$m \mathbf{N} 1\f$, used in the generalized eigen vector problem, \f$l_r \times l_r\f$ */
     using betas_t = Eigen::Matrix<double, 1, -1>;       /*!< \brief Container type for an array of coefficients \p beta, corresponding to the input data */
@@ -262,35 +285,9 @@ namespace mrs_lib
           const std::chrono::system_clock::time_point fit_start = std::chrono::system_clock::now();
       
           const zs_t zs = m_f_z(xs);
-          const dzdxs_t dzdxs = precalculate_dxdzs(xs, m_f_dzdx);
-      
-          // Find initial conditions through ALS
-          m_ALS_theta = fit_ALS_impl(zs);
-          m_last_theta = m_ALS_theta;
-          m_ALS_theta_set = m_last_theta_set = true;
-          eta_t eta = m_ALS_theta.template block<lr, 1>(0, 0);
-      
-          for (unsigned it = 0; it < m_max_its; it++)
-          {
-            const std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-            const auto fit_dur = now - fit_start;
-            if (m_timeout > ms_t::zero() && fit_dur > m_timeout)
-            {
-              if (m_debug_nth_it > 0)
-                std::cerr << "[RHEIV]: Ending at iteration " << it << " (max " << m_max_its << ") - timed out." << std::endl;
-              break;
-            }
-            const theta_t prev_theta = m_last_theta;
-            const auto [M, N, zc] = calc_MN(eta, zs, Ps, dzdxs);
-            eta = calc_min_eigvec(M, N);
-            m_last_theta = calc_theta(eta, zc);
-            const double dtheta = calc_dtheta(prev_theta, m_last_theta);
-            if (m_debug_nth_it > 0 && it % m_debug_nth_it == 0)
-              std::cout << "[RHEIV]: iteration " << it << " (max " << m_max_its << "), dtheta: " << dtheta << " (min " << m_min_dtheta << ") " << std::endl;
-            if (dtheta < m_min_dtheta)
-                break;
-          }
-          return m_last_theta;
+          // the matrices B only depend on the data, so they are calculated once for all iterations
+          const Bs_t Bs = calc_Bs(xs, Ps);
+          return fit_impl(zs, Bs, fit_start);
         }
 
       /*!
@@ -320,6 +317,142 @@ namespace mrs_lib
         }
       //}
 
+      /* fit_RANSAC() method //{ */
+      /*!
+        * \brief Robustly fit the defined model to the provided data, which may contain outliers.
+        *
+        * Hypotheses of the parameters are generated by the Algebraic Least Squares fit to minimal samples of \f$ l_r \f$ randomly drawn
+        * data points. Each hypothesis is scored by the number of inliers, which are the points with the normalized squared residual
+        * \f$ \left( \mathbf{\theta}^T \mathbf{u}\left( \mathbf{x}_i \right) \right)^2 / \left( \mathbf{\eta}^T \mathbf{B}_i \mathbf{\eta} \right) \f$
+        * (which is \f$ \chi^2 \f$-distributed with one degree of freedom for the inliers) below a threshold. The number of hypotheses
+        * is adapted to the inlier ratio of the best hypothesis so far to achieve the required confidence. The final estimate is
+        * obtained by the RHEIV algorithm, applied to the inliers of the best hypothesis.
+        *
+        * The transformed data points and the matrices \f$ \mathbf{B}_i \f$ are only calculated once and the scoring reuses the same buffers
+        * for all the hypotheses. The scoring is evaluated in parallel if enabled (see set_parallel_evaluation()). The timeout, passed
+        * in the constructor, limits the whole robust fit: when it is reached, no more hypotheses are generated and the RHEIV refinement
+        * is stopped after its initialization.
+        *
+        * \param xs      the data points \f$ \mathbf{x}_i \f$.
+        * \param Ps      the corresponding covariance matrices\f$ \mathbf{P}_i \f$ .
+        * \param params  parameters of the robust fitting.
+        *
+        * \returns  estimate of the parameter vector \f$ \mathbf{\theta} \f$.
+        *
+        * \warning  Note that length of \p xs and \p Ps must be the same and there must be at least \f$ l_r \f$ data points!
+        *
+        */
+        theta_t fit_RANSAC(const xs_t& xs, const Ps_t& Ps, const ransac_params_t& params = {})
+        {
+          assert(m_initialized);
+          assert((size_t)xs.cols() == Ps.size());
+          assert(xs.cols() >= lr);
+          const std::chrono::system_clock::time_point fit_start = std::chrono::system_clock::now();
+
+          const zs_t zs = m_f_z(xs);
+          const Bs_t Bs = calc_Bs(xs, Ps);
+          const int n = zs.cols();
+
+          // buffers, which are reused for all the hypotheses
+          A_t zs_sample;
+          std::array<int, lr> sample_idxs;
+          betas_t errs(n);
+          std::vector<int> counts((n + chunk_size - 1)/chunk_size);
+
+          std::mt19937 gen(params.seed);
+          std::uniform_int_distribution<int> rand_idx(0, n-1);
+          theta_t best_theta;
+          int best_count = 0;
+          unsigned n_hypotheses = params.max_hypotheses;
+          for (unsigned it = 0; it < n_hypotheses; it++)
+          {
+            const auto fit_dur = std::chrono::system_clock::now() - fit_start;
+            if (m_timeout > ms_t::zero() && fit_dur > m_timeout)
+            {
+              if (m_debug_nth_it > 0)
+                std::cerr << "[RHEIV]: Ending at hypothesis " << it << " (max " << n_hypotheses << ") - timed out." << std::endl;
+              break;
+            }
+
+            // draw a minimal sample of distinct points
+            for (int j = 0; j < lr; j++)
+            {
+              do
+                sample_idxs[j] = rand_idx(gen);
+              while (std::find(std::begin(sample_idxs), std::begin(sample_idxs)+j, sample_idxs[j]) != std::begin(sample_idxs)+j);
+              zs_sample.col(j) = zs.col(sample_idxs[j]);
+            }
+
+            theta_t theta;
+            try
+            {
+              theta = fit_minimal(zs_sample);
+            }
+            catch (const eigenvector_exception&)
+            {
+              continue;
+            }
+            const int count = calc_errors(theta, zs, Bs, params.inlier_threshold, errs, counts);
+            if (count > best_count)
+            {
+              best_count = count;
+              best_theta = theta;
+              // the probability that a minimal sample contains only inliers, estimated from the best hypothesis so far
+              const double p_inliers = std::pow(double(best_count)/n, lr);
+              if (p_inliers >= 1.0)
+                break;
+              const double n_needed = std::ceil(std::log(1.0 - params.confidence)/std::log1p(-p_inliers));
+              if (n_needed < n_hypotheses)
+                n_hypotheses = unsigned(std::max(n_needed, 0.0));
+            }
+          }
+
+          // select the inliers of the best hypothesis (all the data are used if no valid hypothesis was found)
+          std::vector<int> inliers;
+          if (best_count >= lr)
+          {
+            calc_errors(best_theta, zs, Bs, params.inlier_threshold, errs, counts);
+            inliers = select_inliers(errs, params.inlier_threshold, best_count);
+          }
+          else
+          {
+            if (m_debug_nth_it > 0)
+              std::cerr << "[RHEIV]: No valid hypothesis found, using all the data." << std::endl;
+            inliers.resize(n);
+            std::iota(std::begin(inliers), std::end(inliers), 0);
+          }
+
+          zs_t zs_inliers(lr, inliers.size());
+          Bs_t Bs_inliers(lr*lr, inliers.size());
+          for (size_t it = 0; it < inliers.size(); it++)
+          {
+            zs_inliers.col(it) = zs.col(inliers.at(it));
+            Bs_inliers.col(it) = Bs.col(inliers.at(it));
+          }
+          const theta_t theta = fit_impl(zs_inliers, Bs_inliers, fit_start);
+
+          // the final inliers are the ones consistent with the refined estimate
+          const int count = calc_errors(theta, zs, Bs, params.inlier_threshold, errs, counts);
+          m_inliers = select_inliers(errs, params.inlier_threshold, count);
+          return theta;
+        }
+      //}
+
+      /* get_inliers() method //{ */
+      /*!
+        * \brief Returns indices of the inliers of the last robust fit.
+        *
+        * \returns  indices of the data points, consistent with the estimate of the last fit_RANSAC() call, in increasing order.
+        *
+        * \warning  The fit_RANSAC() method must be called prior to attempting to get the inliers!
+        *
+        */
+        const std::vector<int>& get_inliers() const
+        {
+          return m_inliers;
+        }
+      //}
+
       /* fit_ALS() method //{ */
       /*!
         * \brief Fit the defined model to the provided data using Algebraic Least Squares (not RHEIV).
@@ -381,10 +514,34 @@ namespace mrs_lib
         }
       //}
 
-  private:
+      /* set_parallel_evaluation() method //{ */
+      /*!
+        * \brief Enables or disables parallel evaluation of the fit.
+        *
+        * The data are split to chunks of a fixed size, which are then processed in parallel by the specified number of threads
+        * (including the calling one) when calculating the matrices \f$ \mathbf{B}_i \f$ and when accumulating the matrices
+        * \f$ \mathbf{M} \f$ and \f$ \mathbf{N} \f$ in each iteration. The partial results of the chunks are always summed in the same
+        * order, so the result does not depend on the number of threads. Parallelization only pays off for large numbers of data points
+        * (thousands and more).
+        *
+        * \param n_threads    total number of threads to be used (one or less disables the parallel evaluation, which is the default).
+        *
+        * \warning  The function \f$ \partial_{\mathbf{x}} \mathbf{z}\left( \mathbf{x} \right) \f$, passed in the constructor, must be thread-safe
+        *           when the parallel evaluation is enabled, because it is called concurrently from several threads!
+        */
+        void set_parallel_evaluation(const int n_threads)
+        {
+          if (n_threads > 1)
+            m_thread_pool = std::make_shared<impl::ParallelFor>(n_threads);
+          else
+            m_thread_pool = nullptr;
+        }
+      //}
+
+  protected:
     bool m_initialized;
 
-  private:
+  protected:
     f_z_t m_f_z;
     f_dzdx_t m_f_dzdx;
     double m_min_dtheta;
@@ -392,73 +549,170 @@ namespace mrs_lib
     ms_t m_timeout;
     int m_debug_nth_it;
 
-  private:
+  protected:
     bool m_ALS_theta_set;
     theta_t m_ALS_theta;
     bool m_last_theta_set;
     theta_t m_last_theta;
 
-  private:
+  protected:
+    static constexpr int chunk_size = 1024;              // number of data points, processed in one parallel task
+    std::shared_ptr<impl::ParallelFor> m_thread_pool;    // may be shared by copies of this object (parallel runs are serialized)
+
+  protected:
+    std::vector<int> m_inliers;
+
+  protected:
+    /* for_chunks() method //{ */
+    // calls fun(chunk_index, first_column, n_columns) for all chunks of n columns - in parallel if enabled
+    template <typename F>
+    void for_chunks(const int n, const F& fun) const
+    {
+      const int n_chunks = (n + chunk_size - 1)/chunk_size;
+      const auto task = [&fun, n](const int chunk)
+      {
+        const int first = chunk*chunk_size;
+        fun(chunk, first, std::min(chunk_size, n - first));
+      };
+      if (m_thread_pool && n_chunks > 1)
+        m_thread_pool->run(n_chunks, task);
+      else
+        for (int chunk = 0; chunk < n_chunks; chunk++)
+          task(chunk);
+    }
+    //}
+
+    /* fit_impl() method //{ */
+    // the RHEIV iteration, which is stopped when the timeout is reached (measured from fit_start)
+    theta_t fit_impl(const zs_t& zs, const Bs_t& Bs, const std::chrono::system_clock::time_point& fit_start)
+    {
+      // Find initial conditions through ALS
+      m_ALS_theta = fit_ALS_impl(zs);
+      m_last_theta = m_ALS_theta;
+      m_ALS_theta_set = m_last_theta_set = true;
+      eta_t eta = m_ALS_theta.template block<lr, 1>(0, 0);
+  
+      for (unsigned it = 0; it < m_max_its; it++)
+      {
+        const std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+        const auto fit_dur = now - fit_start;
+        if (m_timeout > ms_t::zero() && fit_dur > m_timeout)
+        {
+          if (m_debug_nth_it > 0)
+            std::cerr << "[RHEIV]: Ending at iteration " << it << " (max " << m_max_its << ") - timed out." << std::endl;
+          break;
+        }
+        const theta_t prev_theta = m_last_theta;
+        const auto [M, N, zc] = calc_MN(eta, zs, Bs);
+        eta = calc_min_eigvec(M, N);
+        m_last_theta = calc_theta(eta, zc);
+        const double dtheta = calc_dtheta(prev_theta, m_last_theta);
+        if (m_debug_nth_it > 0 && it % m_debug_nth_it == 0)
+          std::cout << "[RHEIV]: iteration " << it << " (max " << m_max_its << "), dtheta: " << dtheta << " (min " << m_min_dtheta << ") " << std::endl;
+        if (dtheta < m_min_dtheta)
+            break;
+      }
+      return m_last_theta;
+    }
+    //}
+
     /* calc_MN() method //{ */
-    std::tuple<M_t, N_t, z_t> calc_MN(const eta_t& eta, const zs_t& zs, const Ps_t& Ps, const dzdxs_t& dzdxs) const
+    std::tuple<M_t, N_t, z_t> calc_MN(const eta_t& eta, const zs_t& zs, const Bs_t& Bs) const
     {
       const int n = zs.cols();
-    
-      const Bs_t Bs = calc_Bs(Ps, dzdxs);
-      const betas_t betas = calc_betas(eta, Bs);
-      const auto [zrs, zc] = reduce_zs(zs, betas);
-    
+      const int n_chunks = (n + chunk_size - 1)/chunk_size;
+
+      // beta_i = 1/(eta^T*B_i*eta) = 1/(vec(eta*eta^T)^T*vec(B_i)), so all betas are obtained by a single matrix product
+      const B_t etaeta = eta*eta.transpose();
+      const Eigen::Map<const Eigen::Matrix<double, lr*lr, 1>> etaeta_vec(etaeta.data());
+      betas_t betas(n);
+      std::vector<double> S0s(n_chunks);
+      std::vector<z_t, Eigen::aligned_allocator<z_t>> S1s(n_chunks);
+      for_chunks(n, [&](const int chunk, const int first, const int len)
+      {
+        auto cbetas = betas.segment(first, len);
+        cbetas.noalias() = etaeta_vec.transpose()*Bs.middleCols(first, len);
+        cbetas = cbetas.cwiseInverse();
+        S0s.at(chunk) = cbetas.sum();
+        S1s.at(chunk).noalias() = zs.middleCols(first, len)*cbetas.transpose();
+      });
+      // the partial results are always summed in the same order, so that the result does not depend on the number of threads
+      double S0 = 0.0;
+      z_t S1 = z_t::Zero();
+      for (int chunk = 0; chunk < n_chunks; chunk++)
+      {
+        S0 += S0s.at(chunk);
+        S1 += S1s.at(chunk);
+      }
+      const z_t zc = S1/S0;
+
+      // M = sum(beta_i*zr_i*zr_i^T) and N = sum((eta^T*zr_i)^2*beta_i^2*B_i), where zr_i = z_i - zc
+      std::vector<M_t, Eigen::aligned_allocator<M_t>> Ms(n_chunks);
+      std::vector<N_t, Eigen::aligned_allocator<N_t>> Ns(n_chunks);
+      for_chunks(n, [&](const int chunk, const int first, const int len)
+      {
+        const zs_t zrs = zs.middleCols(first, len).colwise() - zc;
+        const auto cbetas = betas.segment(first, len);
+        Ms.at(chunk).noalias() = zrs*cbetas.asDiagonal()*zrs.transpose();
+        const betas_t ws = ((eta.transpose()*zrs).array()*cbetas.array()).square();
+        Eigen::Map<Eigen::Matrix<double, lr*lr, 1>>(Ns.at(chunk).data()).noalias() = Bs.middleCols(first, len)*ws.transpose();
+      });
       M_t M = M_t::Zero();
       N_t N = N_t::Zero();
-      for (int it = 0; it < n; it++)
+      for (int chunk = 0; chunk < n_chunks; chunk++)
       {
-          const double beta = betas(it);
-          const z_t& zr = zrs.col(it);
-          const B_t& B = Bs.at(it);
-          const A_t A = calc_A(zr);
-          M += A*beta;
-          N += (eta.transpose()*A*eta)*B*(beta*beta);
+        M += Ms.at(chunk);
+        N += Ns.at(chunk);
       }
       return {M, N, zc};
     }
     //}
 
     /* calc_Bs() method //{ */
-    Bs_t calc_Bs(const Ps_t& Ps, const dzdxs_t& dzdxs) const
+    Bs_t calc_Bs(const xs_t& xs, const Ps_t& Ps) const
     {
-      const int n = Ps.size();
-      Bs_t Bs;
-      Bs.reserve(n);
-      for (int it = 0; it < n; it++)
+      const int n = xs.cols();
+      Bs_t Bs(lr*lr, n);
+      for_chunks(n, [&](const int, const int first, const int len)
       {
-        const P_t& P = Ps.at(it);
-        const dzdx_t& dzdx = dzdxs.at(it);
-        const B_t B = dzdx*P*dzdx.transpose();
-        Bs.push_back(B);
-      }
+        for (int it = first; it < first + len; it++)
+        {
+          const dzdx_t dzdx = m_f_dzdx(xs.col(it));
+          Eigen::Map<B_t>(Bs.col(it).data()).noalias() = dzdx*Ps.at(it)*dzdx.transpose();
+        }
+      });
       return Bs;
     }
     //}
 
-    /* calc_betas() method //{ */
-    betas_t calc_betas(const eta_t& eta, const Bs_t& Bs) const
+    /* calc_errors() method //{ */
+    // calculates the normalized squared residuals of all the data points to errs and returns the number of inliers
+    int calc_errors(const theta_t& theta, const zs_t& zs, const Bs_t& Bs, const double threshold, betas_t& errs, std::vector<int>& counts) const
     {
-      const int n = Bs.size();
-      betas_t betas(n);
-      for (int it = 0; it < n; it++)
+      const eta_t eta = theta.template head<lr>();
+      const double alpha = theta(lr);
+      const B_t etaeta = eta*eta.transpose();
+      const Eigen::Map<const Eigen::Matrix<double, lr*lr, 1>> etaeta_vec(etaeta.data());
+      for_chunks(zs.cols(), [&](const int chunk, const int first, const int len)
       {
-          const B_t& B = Bs.at(it);
-          const double beta = 1.0/(eta.transpose()*B*eta);
-          betas(it) = beta;
-      }
-      return betas;
+        auto cerrs = errs.segment(first, len);
+        cerrs.noalias() = etaeta_vec.transpose()*Bs.middleCols(first, len);
+        cerrs = ((eta.transpose()*zs.middleCols(first, len)).array() + alpha).square()/cerrs.array();
+        counts.at(chunk) = (cerrs.array() < threshold).count();
+      });
+      return std::accumulate(std::begin(counts), std::end(counts), 0);
     }
     //}
 
-    /* calc_A() method //{ */
-    A_t calc_A(const z_t& z) const
+    /* select_inliers() method //{ */
+    std::vector<int> select_inliers(const betas_t& errs, const double threshold, const int count) const
     {
-      return z*z.transpose();
+      std::vector<int> inliers;
+      inliers.reserve(count);
+      for (int it = 0; it < errs.cols(); it++)
+        if (errs(it) < threshold)
+          inliers.push_back(it);
+      return inliers;
     }
     //}
 
@@ -502,38 +756,6 @@ namespace mrs_lib
     }
     //}
 
-    /* precalculate_dxdzs() method //{ */
-    dzdxs_t precalculate_dxdzs(const xs_t& xs, const f_dzdx_t& f_dzdx)
-    {
-      const int n = xs.cols();
-      dzdxs_t ret;
-      ret.reserve(n);
-      for (int it = 0; it < n; it++)
-      {
-        const x_t& x = xs.col(it);
-        ret.push_back(f_dzdx(x));
-      }
-      return ret;
-    }
-    //}
-
-    /* calc_centroid() method //{ */
-    z_t calc_centroid(const zs_t& zs, const betas_t& betas) const
-    {
-      const z_t zc = (zs.array().rowwise() * betas.array()).rowwise().sum()/betas.sum();
-      return zc;
-    }
-    //}
-
-    /* reduce_zs() method //{ */
-    std::pair<zs_t, z_t> reduce_zs(const zs_t& zs, const betas_t& betas) const
-    {
-      const z_t zc = calc_centroid(zs, betas);
-      const zs_t zrs = zs.colwise() - zc;
-      return {zrs, zc};
-    }
-    //}
-
     /* cont_to_eigen() method //{ */
     template <typename T_it>
     xs_t cont_to_eigen(const T_it& begin, const T_it& end)
@@ -583,16 +805,22 @@ namespace mrs_lib
       return {zrs, zc};
     }
 
+    // ALS fit to a minimal sample of the data points (fixed-size, so no allocations are necessary)
+    theta_t fit_minimal(const A_t& zs) const
+    {
+      const z_t zc = zs.rowwise().mean();
+      const A_t zrs = zs.colwise() - zc;
+      M_t M;
+      M.noalias() = zrs*zrs.transpose();
+      const eta_t eta = calc_min_eigvec(M);
+      return calc_theta(eta, zc);
+    }
+
     theta_t fit_ALS_impl(const zs_t& zs) const
     {
       const auto [zrs, zc] = reduce_zs(zs);
-      M_t M = M_t::Zero();
-      for (int it = 0; it < zrs.cols(); it++)
-      {
-        const z_t& z = zrs.col(it);
-        const A_t A = calc_A(z);
-        M += A;
-      }
+      M_t M;
+      M.noalias() = zrs*zrs.transpose();
       const eta_t eta = calc_min_eigvec(M);
       const theta_t theta = calc_theta(eta, zc);
       return theta;
@@ -600,6 +828,306 @@ namespace mrs_lib
 
   };
   //}
+
+  /* class RHEIV_streaming //{ */
+  /**
+  * \brief Implementation of the RHEIV surface fitting algorithm for a sliding window of samples.
+  *
+  * This class fits the same model as the RHEIV class and the iteration converges to the same estimate, but the samples
+  * are added and retired incrementally using the add() and remove() methods instead of passing the whole data to each fit() call.
+  * This is useful when fitting a model to a sliding window of many samples, which changes only a little between the fits.
+  *
+  * The transformed samples \f$ \mathbf{z}_i \f$ and the matrices \f$ \mathbf{B}_i \f$ are only calculated once, when the sample is added.
+  * The matrices \f$ \mathbf{M} \f$ and \f$ \mathbf{N} \f$ are calculated from running sums of the per-sample contributions,
+  * which are expanded so that they don't depend on the centroid \f$ \mathbf{z}_c \f$ of the samples, but only on the current
+  * reduced parameter vector \f$ \mathbf{\eta} \f$. The iteration is warm-started with the \f$ \mathbf{\eta} \f$ of the last fit,
+  * so the running sums only have to be updated with the added and retired samples. If the estimate doesn't change in the first
+  * iteration, the cost of the fit is thus proportional to the number of the changed samples. Otherwise, the sums are recalculated
+  * for the new \f$ \mathbf{\eta} \f$ in each following iteration, which is proportional to the number of samples in the window
+  * (the same as one iteration of the RHEIV::fit() method, but without recalculating the transformed samples and the Jacobians).
+  *
+  * \tparam n_states         length of the data sample vector \f$ \mathbf{x} \f$.
+  * \tparam n_params         length of the parameter vector \f$ \mathbf{\theta} \f$.
+  *
+  */
+  template <int n_states, int n_params>
+  class RHEIV_streaming : public RHEIV<n_states, n_params>
+  {
+  public:
+    /* RHEIV_streaming definitions (typedefs, constants etc) //{ */
+    using Base_class = RHEIV<n_states, n_params>;   /*!< \brief Base class of this class. */
+
+    static const int k = Base_class::k;             /*!< \brief Length of the state vector \p x */
+    static const int l = Base_class::l;             /*!< \brief Length of the parameter vector \f$ \mathbf{\theta} \f$ */
+    static const int lr = Base_class::lr;           /*!< \brief Length of the reduced parameter vector \f$ \mathbf{\eta} \f$. */
+
+    using x_t = typename Base_class::x_t;           /*!< \brief Input vector type \f$k \times 1\f$ */
+    using xs_t = typename Base_class::xs_t;         /*!< \brief Container type for the input data array */
+    using P_t = typename Base_class::P_t;           /*!< \brief Covariance type of the input vector \f$k \times k\f$ */
+    using Ps_t = typename Base_class::Ps_t;         /*!< \brief Container type for covariances \p P of the input data array */
+    using z_t = typename Base_class::z_t;           /*!< \brief Type of a reduced transformed input vector \f$l_r \times 1\f$ */
+    using zs_t = typename Base_class::zs_t;         /*!< \brief Container type for an array of the reduced transformed input vectors \p z */
+    using theta_t = typename Base_class::theta_t;   /*!< \brief Parameter vector type \f$l \times 1\f$ */
+    using eta_t = typename Base_class::eta_t;       /*!< \brief Reduced parameter vector type \f$l_r \times 1\f$ */
+
+  protected:
+    using A_t = typename Base_class::A_t;
+    using B_t = typename Base_class::B_t;
+    using M_t = typename Base_class::M_t;
+    using N_t = typename Base_class::N_t;
+    using ms_t = typename Base_class::ms_t;
+
+    // the precalculated data of a single sample
+    struct sample_t
+    {
+      z_t z;
+      B_t B;
+    };
+
+    // running sums of the per-sample contributions for a specific eta (the samples are offset by z_ref for better numerical conditioning)
+    struct sums_t
+    {
+      double S0 = 0.0;              // sum of beta
+      z_t S1 = z_t::Zero();         // sum of beta*z
+      A_t S2 = A_t::Zero();         // sum of beta*z*z^T
+      B_t T0 = B_t::Zero();         // sum of beta^2*B
+      B_t T1 = B_t::Zero();         // sum of beta^2*(eta^T*z)*B
+      B_t T2 = B_t::Zero();         // sum of beta^2*(eta^T*z)^2*B
+    };
+    //}
+
+  public:
+    /* constructor //{ */
+    using Base_class::Base_class;
+    //}
+
+    /* add() method //{ */
+    /*!
+      * \brief Adds new samples to the window.
+      *
+      * If the length of the window is limited (see set_window_length()), the oldest samples are retired as necessary.
+      *
+      * \param xs the new data points \f$ \mathbf{x}_i \f$.
+      * \param Ps the corresponding covariance matrices \f$ \mathbf{P}_i \f$.
+      *
+      * \warning  Note that length of \p xs and \p Ps must be the same!
+      */
+    void add(const xs_t& xs, const Ps_t& Ps)
+    {
+      assert(this->m_initialized);
+      assert((size_t)xs.cols() == Ps.size());
+      const zs_t zs = this->m_f_z(xs);
+      for (int it = 0; it < xs.cols(); it++)
+      {
+        const auto dzdx = this->m_f_dzdx(xs.col(it));
+        const sample_t sample = {zs.col(it), dzdx * Ps.at(it) * dzdx.transpose()};
+        m_samples.push_back(sample);
+        update_sums(sample, 1.0);
+      }
+      if (m_window_length > 0 && m_samples.size() > m_window_length)
+        remove(m_samples.size() - m_window_length);
+    }
+
+    /*!
+      * \brief Adds a new sample to the window.
+      *
+      * If the length of the window is limited (see set_window_length()), the oldest sample is retired as necessary.
+      *
+      * \param x the new data point \f$ \mathbf{x} \f$.
+      * \param P the corresponding covariance matrix \f$ \mathbf{P} \f$.
+      */
+    void add(const x_t& x, const P_t& P)
+    {
+      add(xs_t(x), Ps_t{P});
+    }
+    //}
+
+    /* remove() method //{ */
+    /*!
+      * \brief Retires the oldest samples from the window.
+      *
+      * \param n_samples number of the samples to be retired (if larger than the number of samples in the window, all samples are retired).
+      */
+    void remove(const size_t n_samples)
+    {
+      const size_t n_remove = std::min(n_samples, m_samples.size());
+      for (size_t it = 0; it < n_remove; it++)
+      {
+        update_sums(m_samples.front(), -1.0);
+        m_samples.pop_front();
+      }
+      if (m_samples.empty())
+        clear();
+    }
+    //}
+
+    /* clear() method //{ */
+    /*!
+      * \brief Retires all samples from the window and resets the warm start.
+      */
+    void clear()
+    {
+      m_samples.clear();
+      m_sums = {};
+      m_sums_valid = false;
+      m_n_updates = 0;
+    }
+    //}
+
+    /* size() method //{ */
+    /*!
+      * \brief Returns the current number of samples in the window.
+      */
+    size_t size() const
+    {
+      return m_samples.size();
+    }
+    //}
+
+    /* set_window_length() method //{ */
+    /*!
+      * \brief Sets the maximal number of samples in the window.
+      *
+      * When more samples are added, the oldest samples are automatically retired. If the current number of samples is higher,
+      * the oldest samples are retired immediately.
+      *
+      * \param window_length maximal number of samples in the window (zero means unlimited, which is the default).
+      */
+    void set_window_length(const size_t window_length)
+    {
+      m_window_length = window_length;
+      if (m_window_length > 0 && m_samples.size() > m_window_length)
+        remove(m_samples.size() - m_window_length);
+    }
+    //}
+
+    /* fit() method //{ */
+    /*!
+      * \brief Fit the defined model to the samples in the window.
+      *
+      * The RHEIV iterative optimization algorithm will be applied to estimate optimal parameters of the model based on the samples
+      * in the window. The iteration is warm-started from the result of the last fit (the first fit is initialized using the ALS).
+      *
+      * \returns  estimate of the parameter vector \f$ \mathbf{\theta} \f$.
+      *
+      * \warning  At least one sample must be in the window!
+      */
+    theta_t fit()
+    {
+      assert(this->m_initialized);
+      assert(!m_samples.empty());
+      const std::chrono::system_clock::time_point fit_start = std::chrono::system_clock::now();
+
+      if (!m_sums_valid)
+      {
+        // Find initial conditions through ALS
+        zs_t zs(lr, m_samples.size());
+        for (size_t it = 0; it < m_samples.size(); it++)
+          zs.col(it) = m_samples.at(it).z;
+        this->m_ALS_theta = this->fit_ALS_impl(zs);
+        this->m_last_theta = this->m_ALS_theta;
+        this->m_ALS_theta_set = this->m_last_theta_set = true;
+        m_z_ref = zs.rowwise().mean();
+        recalculate_sums(this->m_ALS_theta.template head<lr>());
+      }
+      // the incremental updates would slowly accumulate rounding errors, so the sums are recalculated after each pass through the window,
+      // and they are also recalculated if the last fit was stopped before the estimate converged (e.g. by the timeout)
+      else if (m_n_updates > m_samples.size() || std::min((m_eta - m_sums_eta).norm(), (m_eta + m_sums_eta).norm()) >= this->m_min_dtheta)
+      {
+        recalculate_sums(m_eta);
+      }
+
+      for (unsigned it = 0; it < this->m_max_its; it++)
+      {
+        const std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+        const auto fit_dur = now - fit_start;
+        if (this->m_timeout > ms_t::zero() && fit_dur > this->m_timeout)
+        {
+          if (this->m_debug_nth_it > 0)
+            std::cerr << "[RHEIV_streaming]: Ending at iteration " << it << " (max " << this->m_max_its << ") - timed out." << std::endl;
+          break;
+        }
+        // the first iteration uses the sums from the last fit, updated by the changed samples
+        if (it > 0)
+          recalculate_sums(m_eta);
+        const theta_t prev_theta = this->m_last_theta;
+        const auto [M, N, zc] = calc_MN();
+        const eta_t eta = this->calc_min_eigvec(M, N);
+        this->m_last_theta = this->calc_theta(eta, zc);
+        m_eta = eta;
+        const double dtheta = this->calc_dtheta(prev_theta, this->m_last_theta);
+        if (this->m_debug_nth_it > 0 && it % this->m_debug_nth_it == 0)
+          std::cout << "[RHEIV_streaming]: iteration " << it << " (max " << this->m_max_its << "), dtheta: " << dtheta << " (min " << this->m_min_dtheta << ") " << std::endl;
+        if (dtheta < this->m_min_dtheta)
+            break;
+      }
+      return this->m_last_theta;
+    }
+    //}
+
+  protected:
+    std::deque<sample_t> m_samples;
+    size_t m_window_length = 0;
+
+    bool m_sums_valid = false;
+    sums_t m_sums;
+    eta_t m_sums_eta;   // the eta, for which the sums are calculated
+    eta_t m_eta;        // the eta, estimated in the last iteration
+    z_t m_z_ref;        // the samples are offset by this vector in the sums
+    size_t m_n_updates = 0;
+
+  protected:
+    /* update_sums() method //{ */
+    // adds (sign = 1) or subtracts (sign = -1) the contributions of a sample to the sums
+    void update_sums(const sample_t& sample, const double sign)
+    {
+      if (!m_sums_valid)
+        return;
+      const z_t z = sample.z - m_z_ref;
+      const double beta = 1.0/(m_sums_eta.transpose()*sample.B*m_sums_eta);
+      const double a = m_sums_eta.dot(z);
+      const double wbeta = sign*beta;
+      const double wbeta2 = wbeta*beta;
+      m_sums.S0 += wbeta;
+      m_sums.S1 += wbeta*z;
+      m_sums.S2.noalias() += wbeta*z*z.transpose();
+      m_sums.T0 += wbeta2*sample.B;
+      m_sums.T1 += (wbeta2*a)*sample.B;
+      m_sums.T2 += (wbeta2*a*a)*sample.B;
+      m_n_updates++;
+    }
+    //}
+
+    /* recalculate_sums() method //{ */
+    void recalculate_sums(const eta_t& eta)
+    {
+      // offset the samples by their last centroid for better numerical conditioning
+      if (m_sums_valid && m_sums.S0 != 0.0)
+        m_z_ref += m_sums.S1/m_sums.S0;
+      m_sums = {};
+      m_sums_eta = eta;
+      m_sums_valid = true;
+      for (const auto& sample : m_samples)
+        update_sums(sample, 1.0);
+      m_n_updates = 0;
+    }
+    //}
+
+    /* calc_MN() method //{ */
+    // the same as RHEIV::calc_MN(), but uses the running sums
+    std::tuple<M_t, N_t, z_t> calc_MN() const
+    {
+      // M = sum(beta*(z - zc)*(z - zc)^T) = S2 - S1*S1^T/S0
+      const z_t zc_rel = m_sums.S1/m_sums.S0;
+      const M_t M = m_sums.S2 - m_sums.S1*zc_rel.transpose();
+      // N = sum(beta^2*(eta^T*(z - zc))^2*B) = T2 - 2*c*T1 + c^2*T0, where c = eta^T*zc
+      const double c = m_sums_eta.dot(zc_rel);
+      const N_t N = m_sums.T2 - 2.0*c*m_sums.T1 + c*c*m_sums.T0;
+      return {M, N, zc_rel + m_z_ref};
+    }
+    //}
+  };
+  //}
   
 }
 
@@ -9,9 +9,14 @@
  */
 
 #include <mrs_lib/kalman_filter.h>
+#include <memory>
 
 namespace mrs_lib
 {
+  namespace impl
+  {
+    class ParallelFor;
+  }
 
   /**
   * \brief Implementation of the Unscented Kalman filter \cite UKF.
@@ -47,8 +52,6 @@ namespace mrs_lib
 
     using Base_class = KalmanFilter<n, m, p>; /*!< \brief Base class of this class. */
 
-    using X_t = typename Eigen::Matrix<double, n, w>;    /*!< \brief State sigma points matrix. */
-    using Z_t = typename Eigen::Matrix<double, p, w>;    /*!< \brief Measurement sigma points matrix. */
     using Pzz_t = typename Eigen::Matrix<double, p, p>;  /*!< \brief Pzz helper matrix. */
     using K_t = typename Eigen::Matrix<double, n, p>;    /*!< \brief Kalman gain matrix. */
     //}
@@ -69,12 +72,20 @@ namespace mrs_lib
     using Q_t = typename Base_class::Q_t;
     //! weights vector (2n+1)*1 typedef
     using W_t = typename Eigen::Matrix<double, w, 1>;
+    //! state sigma points matrix n*(2n+1) typedef
+    using X_t = typename Eigen::Matrix<double, n, w>;
+    //! measurement sigma points matrix p*(2n+1) typedef
+    using Z_t = typename Eigen::Matrix<double, p, w>;
     //! typedef of a helper struct for state and covariance
     using statecov_t = typename Base_class::statecov_t;
     //! function of the state transition model typedef
     using transition_model_t = typename std::function<x_t(const x_t&, const u_t&, double)>;
     //! function of the observation model typedef
     using observation_model_t = typename std::function<z_t(const x_t&)>;
+    //! function of the state transition model, applied to all sigma points at once, typedef
+    using batch_transition_model_t = typename std::function<X_t(const X_t&, const u_t&, double)>;
+    //! function of the observation model, applied to all sigma points at once, typedef
+    using batch_observation_model_t = typename std::function<Z_t(const X_t&)>;
 
     //! is thrown when taking the square root of a matrix fails during sigma generation
     struct square_root_exception : public std::exception
@@ -171,6 +182,49 @@ namespace mrs_lib
     void setObservationModel(const observation_model_t& observation_model);
     //}
 
+    /* setBatchTransitionModel() method //{ */
+  /*!
+    * \brief Changes the transition model to a function, which propagates all sigma points at once.
+    *
+    * The function gets the matrix of the sigma points (one point per column) and returns the matrix of the propagated points.
+    * This enables implementing the model using vectorized operations over the columns and avoids calling the model once
+    * for each sigma point. If set, it is used instead of the model passed to the constructor or setTransitionModel().
+    * An empty function switches back to the per-point model.
+    *
+    * \param transition_model   the new transition model
+    */
+    void setBatchTransitionModel(const batch_transition_model_t& transition_model);
+    //}
+
+    /* setBatchObservationModel() method //{ */
+  /*!
+    * \brief Changes the observation model to a function, which transforms all sigma points at once.
+    *
+    * The function gets the matrix of the sigma points (one point per column) and returns the matrix of the corresponding
+    * expected measurements (see setBatchTransitionModel()). If set, it is used instead of the model passed to the constructor
+    * or setObservationModel(). An empty function switches back to the per-point model.
+    *
+    * \param observation_model   the new observation model
+    */
+    void setBatchObservationModel(const batch_observation_model_t& observation_model);
+    //}
+
+    /* setParallelEvaluation() method //{ */
+  /*!
+    * \brief Enables or disables parallel evaluation of the per-point transition and observation models over the sigma points.
+    *
+    * When enabled, the sigma points are distributed among an internal pool of threads (the calling thread included).
+    * This only pays off for expensive models (eg. ray-casting or camera projection) - for cheap models, the synchronization
+    * overhead is higher than the gain (see the `ukf_parallel_benchmark`). Each sigma point is evaluated independently
+    * and its result is written to its own column, so the results are deterministic and the same as with serial evaluation.
+    * The models have to be thread-safe. The batch models (see setBatchTransitionModel()) are not affected.
+    * Copies of the UKF object share the thread pool. It is disabled by default.
+    *
+    * \param n_threads   the number of threads used for the evaluation including the calling thread (one or less disables the parallel evaluation).
+    */
+    void setParallelEvaluation(const int n_threads);
+    //}
+
   protected:
     /* protected methods and member variables //{ */
 
@@ -178,6 +232,10 @@ namespace mrs_lib
 
     X_t computeSigmas(const x_t& x, const P_t& P) const;
 
+    X_t transitionSigmas(const X_t& S, const u_t& u, const double dt) const;
+
+    Z_t observeSigmas(const X_t& S, const int z_rows) const;
+
     P_t computePaSqrt(const P_t& P) const;
 
     Pzz_t computeInverse(const Pzz_t& Pzz) const;
@@ -190,6 +248,190 @@ namespace mrs_lib
 
     transition_model_t m_transition_model;
     observation_model_t m_observation_model;
+    batch_transition_model_t m_batch_transition_model;
+    batch_observation_model_t m_batch_observation_model;
+
+    std::shared_ptr<impl::ParallelFor> m_thread_pool;
+
+    //}
+  };
+
+  /**
+  * \brief Implementation of the square-root form of the Unscented Kalman filter \cite SRUKF.
+  *
+  * Instead of the state covariance matrix \f$ \mathbf{P} \f$, this variant propagates its lower-triangular Cholesky factor
+  * \f$ \mathbf{S} \f$ such that \f$ \mathbf{P} = \mathbf{S}\mathbf{S}^\intercal \f$ (see the sqrt_statecov_t struct).
+  * The sigma points are generated directly from the factor, so no Cholesky decomposition of the covariance is needed.
+  * The factor of the predicted covariance is obtained using a QR decomposition of the weighted sigma point deviations and
+  * a rank-1 update by the central sigma point. The Kalman gain is computed using triangular solves with the factor
+  * of the innovation covariance and the corrected factor is obtained by \f$ p \f$ rank-1 downdates. No matrix is inverted
+  * or artificially inflated. If a downdate fails because the covariance would stop being positive definite,
+  * the square_root_exception is thrown.
+  *
+  * The correct() and predict() methods, working with the sqrt_statecov_t struct, should be used in performance-critical code.
+  * The methods working with the statecov_t struct, required by the KalmanFilter interface, are also implemented (so that this
+  * class may be used as a drop-in replacement of the UKF), but they compute the factor from the covariance (and vice versa) on each call.
+  * The weights of the sigma points are the same as in the UKF, so the results are the same up to numerical errors.
+  *
+  * \tparam n_states         number of states of the system (length of the \f$ \mathbf{x} \f$ vector).
+  * \tparam n_inputs         number of inputs of the system (length of the \f$ \mathbf{u} \f$ vector).
+  * \tparam n_measurements   number of measurements of the system (length of the \f$ \mathbf{z} \f$ vector).
+  *
+  */
+  template <int n_states, int n_inputs, int n_measurements>
+  class sqrtUKF : public UKF<n_states, n_inputs, n_measurements>
+  {
+  protected:
+    /* protected sqrtUKF definitions (typedefs, constants etc) //{ */
+    static constexpr int n = n_states;            /*!< \brief Length of the state vector of the system. */
+    static constexpr int m = n_inputs;            /*!< \brief Length of the input vector of the system. */
+    static constexpr int p = n_measurements;      /*!< \brief Length of the measurement vector of the system. */
+    static constexpr int w = 2 * n + 1;           /*!< \brief Number of sigma points/weights. */
+
+    using Base_class = UKF<n, m, p>;              /*!< \brief Base class of this class. */
+
+    using K_t = typename Base_class::K_t;         /*!< \brief Kalman gain matrix. */
+    using Pzz_t = typename Base_class::Pzz_t;     /*!< \brief Pzz helper matrix. */
+    //}
+
+  public:
+    /* public sqrtUKF definitions (typedefs, constants etc) //{ */
+    using x_t = typename Base_class::x_t;                  /*!< \brief State vector type \f$n \times 1\f$ */
+    using u_t = typename Base_class::u_t;                  /*!< \brief Input vector type \f$m \times 1\f$ */
+    using z_t = typename Base_class::z_t;                  /*!< \brief Measurement vector type \f$p \times 1\f$ */
+    using P_t = typename Base_class::P_t;                  /*!< \brief State uncertainty covariance matrix type \f$n \times n\f$ */
+    using R_t = typename Base_class::R_t;                  /*!< \brief Measurement noise covariance matrix type \f$p \times p\f$ */
+    using Q_t = typename Base_class::Q_t;                  /*!< \brief Process noise covariance matrix type \f$n \times n\f$ */
+    using X_t = typename Base_class::X_t;                  /*!< \brief State sigma points matrix type \f$n \times (2n+1)\f$ */
+    using Z_t = typename Base_class::Z_t;                  /*!< \brief Measurement sigma points matrix type \f$p \times (2n+1)\f$ */
+    using statecov_t = typename Base_class::statecov_t;    /*!< \brief Helper struct for passing around the state and its covariance in one variable */
+    using transition_model_t = typename Base_class::transition_model_t;    /*!< \brief Function of the state transition model */
+    using observation_model_t = typename Base_class::observation_model_t;  /*!< \brief Function of the observation model */
+    using square_root_exception = typename Base_class::square_root_exception;  /*!< \brief Thrown when the covariance factor cannot be updated */
+    using inverse_exception = typename Base_class::inverse_exception;          /*!< \brief Thrown when the measurement noise covariance is not positive definite */
+    using S_t = Eigen::Matrix<double, n, n>;               /*!< \brief Square-root factor of the state covariance matrix type \f$n \times n\f$ */
+
+    /*!
+      * \brief Helper struct for passing around the state and the square-root factor of its covariance in one variable.
+      */
+    struct sqrt_statecov_t
+    {
+      x_t x;  /*!< \brief State vector. */
+      S_t S;  /*!< \brief Lower-triangular square-root factor of the state covariance matrix (\f$ \mathbf{P} = \mathbf{S}\mathbf{S}^\intercal \f$). */
+      ros::Time stamp = ros::Time(0); /*!< \brief ROS time stamp */
+    };
+    //}
+
+  public:
+  /*!
+    * \brief Convenience default constructor.
+    *
+    * This constructor should not be used if applicable. If used, the main constructor has to be called afterwards,
+    * otherwise the object is invalid (not initialized).
+    */
+    sqrtUKF(){};
+
+  /*!
+    * \brief The main constructor.
+    *
+    * \param alpha             Scaling parameter of the sigma generation (a small positive value, e.g. 1e-3).
+    * \param kappa             Secondary scaling parameter of the sigma generation (usually set to 0 or 1).
+    * \param beta              Incorporates prior knowledge about the distribution (for Gaussian distribution, 2 is optimal).
+    * \param transition_model  State transition model function.
+    * \param observation_model Observation model function.
+    */
+    sqrtUKF(const transition_model_t& transition_model, const observation_model_t& observation_model, const double alpha = 1e-3, const double kappa = 1, const double beta = 2)
+      : Base_class(transition_model, observation_model, alpha, kappa, beta){};
+
+    /* correct() method //{ */
+  /*!
+    * \brief Implements the state correction step (measurement update) in the square-root form.
+    *
+    * \param sc     Previous estimate of the state and covariance factor.
+    * \param z      Measurement vector.
+    * \param R      Measurement covariance matrix (must be positive definite).
+    * \returns      The state and covariance factor after applying the correction step.
+    */
+    sqrt_statecov_t correct(const sqrt_statecov_t& sc, const z_t& z, const R_t& R) const;
+
+  /*!
+    * \brief Implements the state correction step (measurement update).
+    *
+    * The covariance matrix is factorized, the correction is applied in the square-root form and the covariance is reconstructed.
+    *
+    * \param sc     Previous estimate of the state and covariance.
+    * \param z      Measurement vector.
+    * \param R      Measurement covariance matrix (must be positive definite).
+    * \returns      The state and covariance after applying the correction step.
+    */
+    virtual statecov_t correct(const statecov_t& sc, const z_t& z, const R_t& R) const override
+    {
+      return fromSqrt(correct(toSqrt(sc), z, R));
+    };
+    //}
+
+    /* predict() method //{ */
+  /*!
+    * \brief Implements the state prediction step (time update) in the square-root form.
+    *
+    * \param sc     Previous estimate of the state and covariance factor.
+    * \param u      Input vector.
+    * \param Q      Process noise covariance matrix (must be positive semi-definite).
+    * \param dt     Duration since the previous estimate.
+    * \returns      The state and covariance factor after applying the prediction step.
+    */
+    sqrt_statecov_t predict(const sqrt_statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const;
+
+  /*!
+    * \brief Implements the state prediction step (time update).
+    *
+    * The covariance matrix is factorized, the prediction is applied in the square-root form and the covariance is reconstructed.
+    *
+    * \param sc     Previous estimate of the state and covariance.
+    * \param u      Input vector.
+    * \param Q      Process noise covariance matrix (must be positive semi-definite).
+    * \param dt     Duration since the previous estimate.
+    * \returns      The state and covariance after applying the prediction step.
+    */
+    virtual statecov_t predict(const statecov_t& sc, const u_t& u, const Q_t& Q, double dt) const override
+    {
+      return fromSqrt(predict(toSqrt(sc), u, Q, dt));
+    };
+    //}
+
+    /* toSqrt() method //{ */
+  /*!
+    * \brief Converts the state and covariance to the state and a square-root factor of the covariance.
+    *
+    * \param sc     The state and covariance (the covariance must be positive semi-definite).
+    * \return       The state and a lower-triangular square-root factor of the covariance.
+    */
+    static sqrt_statecov_t toSqrt(const statecov_t& sc);
+    //}
+
+    /* fromSqrt() method //{ */
+  /*!
+    * \brief Converts the state and a square-root factor of the covariance to the state and covariance.
+    *
+    * \param sc     The state and a square-root factor of the covariance.
+    * \return       The state and covariance.
+    */
+    static statecov_t fromSqrt(const sqrt_statecov_t& sc);
+    //}
+
+  protected:
+    /* protected methods //{ */
+
+    X_t computeSigmas(const x_t& x, const S_t& S) const;
+
+    template <int rows>
+    static Eigen::Matrix<double, rows, rows> factorize(const Eigen::Matrix<double, rows, rows>& M);
+
+    template <int rows, int cols>
+    static Eigen::Matrix<double, rows, rows> qrFactor(const Eigen::Matrix<double, rows, cols>& A);
+
+    template <int rows>
+    static void cholUpdate(Eigen::Matrix<double, rows, rows>& L, Eigen::Matrix<double, rows, 1> v, const double sigma);
 
     //}
   };
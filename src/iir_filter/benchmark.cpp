@@ -0,0 +1,133 @@
+/**  \file
+     \brief Benchmark of the IIR filters
+     \author Matouš Vrba - vrbamato@fel.cvut.cz
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib iir_filter_benchmark`.
+     It compares the mean duration of filtering one sample of a 6-axis IMU using the original implementation
+     of IirFilter (the direct form II with a shifted delay line), using six IirFilter objects (the transposed direct form II)
+     and using a single IirFilterN for all the axes, both sample by sample and in blocks of 100 samples.
+ */
+
+#include <mrs_lib/iir_filter.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+/* ReferenceDf2 class //{ */
+// the original implementation - the direct form II with a shifted delay line
+class ReferenceDf2 {
+
+public:
+  ReferenceDf2(const std::vector<double>& a, const std::vector<double>& b) : a_(a), b_(b), buffer_(a.size(), 0.0) {
+  }
+
+  double iterate(const double input) {
+    buffer_[0]    = input;
+    double output = 0;
+    for (size_t i = 1; i < a_.size(); i++) {
+      buffer_[0] += (-a_[i]) * buffer_[i];
+      output += b_[i] * buffer_[i];
+    }
+    output += buffer_[0] * b_[0];
+    for (size_t i = a_.size() - 1; i > 0; i--) {
+      buffer_[i] = buffer_[i - 1];
+    }
+    return output;
+  }
+
+private:
+  std::vector<double> a_;
+  std::vector<double> b_;
+  std::vector<double> buffer_;
+};
+//}
+
+/* measure() function //{ */
+// returns the mean duration of filtering one 6-axis sample in nanoseconds (the input is small enough to stay in the cache,
+// so it is filtered repeatedly to measure the filtering and not the memory throughput)
+template <typename F>
+double measure(F fun, const Eigen::Matrix<double, 6, Eigen::Dynamic>& in) {
+  const int                                n_reps = 1000;
+  Eigen::Matrix<double, 6, Eigen::Dynamic> out(6, in.cols());
+  const auto                               start = std::chrono::steady_clock::now();
+  fun(in, out, n_reps);
+  const std::chrono::duration<double, std::nano> dur = std::chrono::steady_clock::now() - start;
+  // print the result to prevent the compiler from optimizing the filtering away
+  if (!std::isfinite(out.sum()))
+    std::cerr << "the output is not finite" << std::endl;
+  return dur.count() / (n_reps * in.cols());
+}
+//}
+
+/* run() function //{ */
+template <int order>
+void run(const Eigen::Matrix<double, 6, Eigen::Dynamic>& in) {
+  using samples_t = Eigen::Matrix<double, 6, Eigen::Dynamic>;
+  using filter_t  = mrs_lib::IirFilterN<order, 6>;
+  const int block = 100;
+
+  // a stable filter with all poles at 0.5 (the coefficients of (1 - 0.5z^-1)^order) and a moving-average numerator
+  typename filter_t::coeffs_t a_arr;
+  typename filter_t::coeffs_t b_arr;
+  double                      binom = 1.0;
+  for (int i = 0; i <= order; i++) {
+    a_arr[i] = binom * std::pow(-0.5, i);
+    b_arr[i] = 1.0 / (order + 1);
+    binom    = binom * (order - i) / (i + 1);
+  }
+  const std::vector<double> a(std::begin(a_arr), std::end(a_arr));
+  const std::vector<double> b(std::begin(b_arr), std::end(b_arr));
+
+  const double dur_orig = measure(
+      [&](const samples_t& in, samples_t& out, const int n_reps) {
+        std::vector<ReferenceDf2> fils(6, ReferenceDf2(a, b));
+        for (int rep = 0; rep < n_reps; rep++)
+          for (Eigen::Index it = 0; it < in.cols(); it++)
+            for (int ax = 0; ax < 6; ax++)
+              out(ax, it) = fils[ax].iterate(in(ax, it));
+      },
+      in);
+
+  const double dur_tdf2 = measure(
+      [&](const samples_t& in, samples_t& out, const int n_reps) {
+        std::vector<mrs_lib::IirFilter> fils(6, mrs_lib::IirFilter(a, b));
+        for (int rep = 0; rep < n_reps; rep++)
+          for (Eigen::Index it = 0; it < in.cols(); it++)
+            for (int ax = 0; ax < 6; ax++)
+              out(ax, it) = fils[ax].iterate(in(ax, it));
+      },
+      in);
+
+  const double dur_n = measure(
+      [&](const samples_t& in, samples_t& out, const int n_reps) {
+        filter_t fil(a_arr, b_arr);
+        for (int rep = 0; rep < n_reps; rep++)
+          for (Eigen::Index it = 0; it < in.cols(); it++)
+            out.col(it) = fil.iterate(in.col(it));
+      },
+      in);
+
+  const double dur_block = measure(
+      [&](const samples_t& in, samples_t& out, const int n_reps) {
+        filter_t fil(a_arr, b_arr);
+        for (int rep = 0; rep < n_reps; rep++)
+          for (Eigen::Index it = 0; it + block <= in.cols(); it += block)
+            fil.process(in.middleCols(it, block), out.middleCols(it, block));
+      },
+      in);
+
+  std::cout << order << "\t" << dur_orig << "\t\t" << dur_tdf2 << "\t\t" << dur_n << "\t\t" << dur_block << std::endl;
+}
+//}
+
+int main() {
+  const Eigen::Matrix<double, 6, Eigen::Dynamic> in = Eigen::Matrix<double, 6, Eigen::Dynamic>::Random(6, 1000);
+
+  std::cout << "order\toriginal [ns]\t6x IirFilter [ns]\tIirFilterN [ns]\tblocks [ns]" << std::endl;
+  run<1>(in);
+  run<2>(in);
+  run<4>(in);
+  run<8>(in);
+  return 0;
+}
@@ -12,12 +12,10 @@ IirFilter::IirFilter(const std::vector<double>& a_in, const std::vector<double>&
   a_ = a_in;
   b_ = b_in;
 
+  // the filter is evaluated in the transposed direct form II, which needs one state less than the number of coefficients
   order_ = a_.size();
-  buffer_.resize(order_, 0.0);
-  for (size_t i = 0; i < a_.size(); i++) {
-    
-  ROS_INFO_STREAM("a: " << a_[i] << " b: " << b_[i]);
-  }
+  buffer_.resize(order_ > 0 ? order_ - 1 : 0, 0.0);
+
   ROS_INFO("[%s]: IIR filter initialized!", ros::this_node::getName().c_str());
 }
 
@@ -27,22 +25,24 @@ IirFilter::IirFilter(const std::vector<double>& a_in, const std::vector<double>&
 
 double IirFilter::iterate(const double& input) {
 
-  double output = 0;
+  if (order_ == 0) {
+    return 0.0;
+  }
 
-  buffer_[0] = input;
+  const double output = b_[0] * input + (buffer_.empty() ? 0.0 : buffer_[0]);
 
-  for (size_t i = 1; i < order_; i++) {
-    buffer_[0] += (-a_[i]) * buffer_[i];
-    output += (b_[i]) * buffer_[i];
+  // the states are updated in-place, so no delay line has to be shifted
+  for (size_t i = 0; i + 1 < buffer_.size(); i++) {
+    buffer_[i] = b_[i + 1] * input - a_[i + 1] * output + buffer_[i + 1];
   }
 
-  output += buffer_[0] * b_[0];
-
-  for (size_t i = order_ - 1; i > 0; i--) {
-    buffer_[i] = buffer_[i - 1];
+  if (!buffer_.empty()) {
+    buffer_.back() = b_[order_ - 1] * input - a_[order_ - 1] * output;
   }
 
   return output;
 }
 
+//}
+
 }  // namespace mrs_lib
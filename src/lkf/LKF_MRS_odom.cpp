@@ -19,6 +19,21 @@ namespace mrs_lib
   {
     statecov_t ret;
     ret.x = state_predict_optimized(sc.x, u, dt);
+    if (m_steady_state)
+    {
+      m_last_dt = dt;
+      m_last_Q = Q;
+      // the covariance converged for the measurement mapping of the last correction, so it doesn't have to be propagated
+      if (m_last_param >= 0)
+      {
+        const steady_state_t& ss = m_ss.at(m_last_param);
+        if (ss.valid && matches(ss.dt, ss.Q, dt, Q))
+        {
+          ret.P = ss.P_prior;
+          return ret;
+        }
+      }
+    }
     ret.P = covariance_predict_optimized(sc.P, Q, dt);
     /* ret.x = Base_class::state_predict(A, sc.x, B, u); */
     /* ret.P = Base_class::covariance_predict(Base_class::A, sc.P, Base_class::Q); */
@@ -30,7 +45,85 @@ namespace mrs_lib
   LKF_MRS_odom::statecov_t LKF_MRS_odom::correct(const LKF_MRS_odom::statecov_t& sc, const LKF_MRS_odom::z_t& z, const LKF_MRS_odom::R_t& R, int param) const
   {
     /* return correction_impl(sc, z, R, Hs.at(param)); */
-    return correction_optimized(sc, z, R, m_Hs.at(param));
+    if (!m_steady_state || m_last_dt < 0.0)
+      return correction_optimized(sc, z, R, m_Hs.at(param));
+
+    const H_t& H = m_Hs.at(param);
+    steady_state_t& ss = m_ss.at(param);
+    m_last_param = param;
+    if (!ss.valid || !matches(ss.dt, ss.Q, m_last_dt, m_last_Q) || !matches(ss.R, R))
+    {
+      // recompute the converged gain if the parameters are the same as in the last correction with this mapping
+      const bool stable = ss.last_dt >= 0.0 && matches(ss.last_dt, ss.last_Q, m_last_dt, m_last_Q) && matches(ss.last_R, R);
+      ss.last_dt = m_last_dt;
+      ss.last_Q = m_last_Q;
+      ss.last_R = R;
+      if (!stable)
+        return correction_optimized(sc, z, R, H);
+      compute_steady_state(ss, H);
+      if (!ss.valid)
+        return correction_optimized(sc, z, R, H);
+    }
+
+    statecov_t ret;
+    ret.x = sc.x + ss.K * (z - H * sc.x);
+    ret.P = ss.P_post;
+    return ret;
+  }
+  //}
+
+  /* LKF_MRS_odom::setSteadyState() method //{ */
+  void LKF_MRS_odom::setSteadyState(const bool enable, const double dt_threshold, const double noise_threshold)
+  {
+    m_steady_state = enable;
+    m_ss_dt_threshold = dt_threshold;
+    m_ss_noise_threshold = noise_threshold;
+    m_ss.clear();
+    m_ss.resize(m_Hs.size());
+    m_last_dt = -1.0;
+    m_last_param = -1;
+  }
+  //}
+
+  /* LKF_MRS_odom::compute_steady_state() method //{ */
+  // iterates the Riccati equation with the last used parameters of the steady state until the covariance converges
+  void LKF_MRS_odom::compute_steady_state(steady_state_t& ss, const H_t& H) const
+  {
+    const int max_its = 10000;
+    const double rel_tol = 1e-12;
+
+    ss.valid = false;
+    ss.dt = ss.last_dt;
+    ss.Q = ss.last_Q;
+    ss.R = ss.last_R;
+    ss.P_prior = covariance_predict_optimized(P_t::Identity(), ss.Q, ss.dt);
+    for (int it = 0; it < max_its; it++)
+    {
+      ss.K = computeKalmanGain({x_t::Zero(), ss.P_prior}, z_t::Zero(), ss.R, H);
+      ss.P_post = (P_t::Identity() - ss.K * H) * ss.P_prior;
+      const P_t P_prior = covariance_predict_optimized(ss.P_post, ss.Q, ss.dt);
+      const double diff = (P_prior - ss.P_prior).norm();
+      ss.P_prior = P_prior;
+      if (!ss.P_prior.allFinite())
+        return;
+      if (diff <= rel_tol * ss.P_prior.norm())
+      {
+        ss.valid = true;
+        return;
+      }
+    }
+  }
+  //}
+
+  /* LKF_MRS_odom::matches() method //{ */
+  bool LKF_MRS_odom::matches(const double dt1, const Q_t& Q1, const double dt2, const Q_t& Q2) const
+  {
+    return std::abs(dt1 - dt2) <= m_ss_dt_threshold && (Q1 - Q2).norm() <= m_ss_noise_threshold * Q1.norm();
+  }
+
+  bool LKF_MRS_odom::matches(const R_t& R1, const R_t& R2) const
+  {
+    return (R1 - R2).norm() <= m_ss_noise_threshold * R1.norm();
   }
   //}
 
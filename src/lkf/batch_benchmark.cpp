@@ -0,0 +1,105 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the batchLKF, running many identical LKFs at once
+     \author Matouš Vrba - vrbamato@fel.cvut.cz
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib lkf_batch_benchmark`.
+     It compares the mean duration of one prediction and correction of \f$ N \f$ separate LKF objects
+     and of a single batchLKF object with \f$ N \f$ filters for different \f$ N \f$.
+ */
+
+#include <mrs_lib/batch_lkf.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// Define the LKF we will be using - the same model as LKF_MRS_odom
+namespace mrs_lib
+{
+  const int n_states = 3;
+  const int n_inputs = 1;
+  const int n_measurements = 1;
+
+  using lkf_t = LKF<n_states, n_inputs, n_measurements>;
+  using batchlkf_t = batchLKF<n_states, n_inputs, n_measurements>;
+}
+
+using namespace mrs_lib;
+using A_t = lkf_t::A_t;
+using B_t = lkf_t::B_t;
+using H_t = lkf_t::H_t;
+using Q_t = lkf_t::Q_t;
+using x_t = lkf_t::x_t;
+using P_t = lkf_t::P_t;
+using R_t = lkf_t::R_t;
+using statecov_t = lkf_t::statecov_t;
+
+const double dt = 0.01;
+const A_t A((A_t() << 1, dt, 0.5 * dt * dt, 0, 1, dt, 0, 0, 0.9).finished());
+const B_t B((B_t() << 0, 0, 0.1).finished());
+const H_t H((H_t() << 1, 0, 0).finished());
+const Q_t Q = Q_t::Identity();
+const R_t R = 0.01 * R_t::Identity();
+
+/* run() function //{ */
+// runs the benchmark for n_filters and returns the mean durations of one step of all the filters in microseconds
+std::pair<double, double> run(const int n_filters, const int n_its)
+{
+  const batchlkf_t::us_t us = batchlkf_t::us_t::Random(n_filters, n_inputs);
+  const batchlkf_t::zs_t zs = batchlkf_t::zs_t::Random(n_filters, n_measurements);
+  const statecov_t sc0 = {x_t::Zero(), P_t::Identity()};
+
+  std::pair<double, double> ret;
+  // N separate LKF objects
+  {
+    std::vector<lkf_t> lkfs(n_filters, lkf_t(A, B, H));
+    std::vector<statecov_t> scs(n_filters, sc0);
+    const auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < n_its; it++)
+    {
+      for (int f = 0; f < n_filters; f++)
+      {
+        scs[f] = lkfs[f].predict(scs[f], us.row(f).transpose(), Q, dt);
+        scs[f] = lkfs[f].correct(scs[f], zs.row(f).transpose(), R);
+      }
+    }
+    const std::chrono::duration<double, std::micro> dur = std::chrono::steady_clock::now() - start;
+    ret.first = dur.count() / n_its;
+    // print the state to prevent the compiler from optimizing the loop away
+    if (!scs.front().x.allFinite())
+      std::cerr << "the state is not finite: " << scs.front().x.transpose() << std::endl;
+  }
+
+  // one batchLKF with N filters
+  {
+    batchlkf_t batchlkf(A, B, H, n_filters);
+    for (int f = 0; f < n_filters; f++)
+      batchlkf.set(f, sc0);
+    const auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < n_its; it++)
+    {
+      batchlkf.predict(us, Q, dt);
+      batchlkf.correct(zs, R);
+    }
+    const std::chrono::duration<double, std::micro> dur = std::chrono::steady_clock::now() - start;
+    ret.second = dur.count() / n_its;
+    if (!batchlkf.states().allFinite())
+      std::cerr << "the states are not finite" << std::endl;
+  }
+  return ret;
+}
+//}
+
+int main()
+{
+  std::cout << "N\tseparate [us]\tbatch [us]\tspeedup [-]" << std::endl;
+  for (const int n_filters : {1, 4, 16, 64, 256, 1024, 4096})
+  {
+    const int n_its = std::max(100, 1000000 / n_filters);
+    const auto [dur_separate, dur_batch] = run(n_filters, n_its);
+    std::cout << n_filters << "\t" << dur_separate << "\t\t" << dur_batch << "\t\t" << dur_separate / dur_batch << std::endl;
+  }
+  return 0;
+}
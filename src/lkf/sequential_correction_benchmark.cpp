@@ -0,0 +1,79 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the sequential correction of the LKF with a diagonal measurement noise covariance matrix
+     \author Matouš Vrba - vrbamato@fel.cvut.cz
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib lkf_sequential_correction_benchmark`.
+     It compares the mean duration of the standard correction step of the LKF and of the sequential correction (see LKF::setSequentialCorrection())
+     for different numbers of states and measurements.
+ */
+
+#include <mrs_lib/lkf.h>
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+using namespace mrs_lib;
+
+/* run() function //{ */
+// runs the benchmark for a single combination of the number of states and measurements and returns the mean durations of one correction in nanoseconds
+template <int n, int p>
+std::pair<double, double> run(const int n_its)
+{
+  using lkf_t = LKF<n, 1, p>;
+  using P_t = typename lkf_t::P_t;
+
+  const typename lkf_t::A_t A = lkf_t::A_t::Identity();
+  const typename lkf_t::B_t B = lkf_t::B_t::Zero();
+  const typename lkf_t::H_t H = lkf_t::H_t::Random();
+  lkf_t lkf(A, B, H);
+
+  const P_t P_tmp = P_t::Random();
+  const typename lkf_t::statecov_t sc0 = {lkf_t::x_t::Random(), P_tmp * P_tmp.transpose() + P_t::Identity()};
+  const typename lkf_t::z_t z = lkf_t::z_t::Random();
+  const typename lkf_t::R_t R = lkf_t::z_t::Random().cwiseAbs().asDiagonal();
+  // add some process noise after each correction to keep the covariance from converging to zero
+  const P_t Q = 1e-3 * P_t::Identity();
+
+  std::pair<double, double> ret;
+  for (const bool sequential : {false, true})
+  {
+    lkf.setSequentialCorrection(sequential);
+    auto sc = sc0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < n_its; it++)
+    {
+      sc = lkf.correct(sc, z, R);
+      sc.P += Q;
+    }
+    const std::chrono::duration<double, std::nano> dur = std::chrono::steady_clock::now() - start;
+    // print the state to prevent the compiler from optimizing the loop away
+    if (!sc.x.allFinite())
+      std::cerr << "the state is not finite: " << sc.x.transpose() << std::endl;
+    (sequential ? ret.second : ret.first) = dur.count() / n_its;
+  }
+  return ret;
+}
+//}
+
+/* run_all() function //{ */
+template <int n, int... ps>
+void run_all(const int n_its)
+{
+  for (const auto& [p, durs] : {std::make_pair(ps, run<n, ps>(n_its))...})
+    std::cout << n << "\t" << p << "\t" << durs.first << "\t\t" << durs.second << "\t\t" << durs.first / durs.second << std::endl;
+}
+//}
+
+int main()
+{
+  const int n_its = 100000;
+  std::cout << "n\tp\tstandard [ns]\tsequential [ns]\tspeedup [-]" << std::endl;
+  run_all<3, 1, 2, 3, 4, 5, 6>(n_its);
+  run_all<6, 1, 2, 3, 4, 5, 6>(n_its);
+  run_all<9, 1, 2, 3, 4, 5, 6>(n_its);
+  run_all<12, 1, 2, 3, 4, 5, 6>(n_its);
+  run_all<15, 1, 2, 3, 4, 5, 6>(n_its);
+  run_all<18, 1, 2, 3, 4, 5, 6>(n_its);
+  return 0;
+}
@@ -0,0 +1,140 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the sliding-window MedianFilter
+     \author Matouš Vrba - vrbamato@fel.cvut.cz
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib median_filter_benchmark`.
+     It compares the mean duration of adding a new value and obtaining the median using the MedianFilter (which keeps the values
+     sorted in two halves and updates the median incrementally) and using the original implementation (which copies the buffer
+     and partially sorts it using std::nth_element after each new value) for different buffer lengths.
+     It also compares filtering of a 3D vector using a MedianFilter for each channel and using a single MedianFilterN.
+ */
+
+#include <mrs_lib/median_filter.h>
+#include <mrs_lib/median_filter_n.h>
+#include <boost/circular_buffer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/* nth_element_median_t class //{ */
+// the original implementation - the median is recalculated from a copy of the buffer after each new value
+class nth_element_median_t
+{
+public:
+  nth_element_median_t(const size_t buffer_length) : m_buffer(buffer_length)
+  {
+    m_buffer_sorted.reserve(buffer_length);
+  }
+
+  bool addCheck(const double value)
+  {
+    m_buffer.push_back(value);
+    return std::abs(median() - value) < std::numeric_limits<double>::infinity();
+  }
+
+  double median()
+  {
+    m_buffer_sorted.clear();
+    m_buffer_sorted.insert(std::end(m_buffer_sorted), std::begin(m_buffer), std::end(m_buffer));
+    const bool even_set = m_buffer_sorted.size() % 2 == 0;
+    const size_t median_pos = m_buffer_sorted.size() / 2;
+    std::nth_element(std::begin(m_buffer_sorted), std::begin(m_buffer_sorted) + median_pos, std::end(m_buffer_sorted));
+    if (even_set)
+      return (m_buffer_sorted.at(median_pos) + m_buffer_sorted.at(median_pos - 1)) / 2.0;
+    else
+      return m_buffer_sorted.at(median_pos);
+  }
+
+private:
+  boost::circular_buffer<double> m_buffer;
+  std::vector<double> m_buffer_sorted;
+};
+//}
+
+/* measure() function //{ */
+// returns the mean duration of one addCheck() and median() call in nanoseconds
+template <typename Filter>
+double measure(Filter& fil, const std::vector<double>& values)
+{
+  double sum = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  for (const double value : values)
+  {
+    fil.addCheck(value);
+    sum += fil.median();
+  }
+  const std::chrono::duration<double, std::nano> dur = std::chrono::steady_clock::now() - start;
+  // print the result to prevent the compiler from optimizing the loop away
+  if (!std::isfinite(sum))
+    std::cerr << "the median is not finite" << std::endl;
+  return dur.count() / values.size();
+}
+//}
+
+/* measure_channels() function //{ */
+// returns the mean duration of filtering one 3D vector in nanoseconds using a MedianFilter per channel and using a MedianFilterN
+std::pair<double, double> measure_channels(const size_t bfr_len, const std::vector<double>& values)
+{
+  using vec_t = mrs_lib::MedianFilterN<3>::vec_t;
+  const size_t n_vecs = values.size() / 3;
+  double sum = 0.0;
+
+  std::vector<mrs_lib::MedianFilter> fils(3, mrs_lib::MedianFilter(bfr_len));
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t it = 0; it < n_vecs; it++)
+  {
+    for (int ch = 0; ch < 3; ch++)
+    {
+      fils.at(ch).addCheck(values[3 * it + ch]);
+      sum += fils.at(ch).median();
+    }
+  }
+  const std::chrono::duration<double, std::nano> dur = std::chrono::steady_clock::now() - start;
+
+  mrs_lib::MedianFilterN<3> fil_n(bfr_len);
+  const auto start_n = std::chrono::steady_clock::now();
+  for (size_t it = 0; it < n_vecs; it++)
+  {
+    fil_n.addCheck(Eigen::Map<const vec_t>(&values[3 * it]));
+    sum += fil_n.median().sum();
+  }
+  const std::chrono::duration<double, std::nano> dur_n = std::chrono::steady_clock::now() - start_n;
+
+  // print the result to prevent the compiler from optimizing the loops away
+  if (!std::isfinite(sum))
+    std::cerr << "the median is not finite" << std::endl;
+  return {dur.count() / n_vecs, dur_n.count() / n_vecs};
+}
+//}
+
+int main()
+{
+  // simulated noisy rangefinder measurements
+  std::mt19937 gen(42);
+  std::normal_distribution<> noise(5.0, 0.1);
+  std::vector<double> values(1000000);
+  for (auto& value : values)
+    value = noise(gen);
+
+  std::cout << "length\tnth_element [ns]\tincremental [ns]\tspeedup [-]" << std::endl;
+  for (const size_t bfr_len : {10, 50, 200, 1000})
+  {
+    nth_element_median_t fil_orig(bfr_len);
+    mrs_lib::MedianFilter fil(bfr_len);
+    const double dur_orig = measure(fil_orig, values);
+    const double dur = measure(fil, values);
+    std::cout << bfr_len << "\t" << dur_orig << "\t\t\t" << dur << "\t\t\t" << dur_orig / dur << std::endl;
+  }
+
+  std::cout << std::endl << "length\t3x single [ns]\t\tmulti-channel [ns]\tspeedup [-]" << std::endl;
+  for (const size_t bfr_len : {10, 50, 200, 1000})
+  {
+    const auto [dur, dur_n] = measure_channels(bfr_len, values);
+    std::cout << bfr_len << "\t" << dur << "\t\t\t" << dur_n << "\t\t\t" << dur / dur_n << std::endl;
+  }
+  return 0;
+}
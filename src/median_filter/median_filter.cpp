@@ -5,18 +5,15 @@ namespace mrs_lib
   /* constructor overloads //{ */
 
   MedianFilter::MedianFilter(const size_t buffer_length, const double min_value, const double max_value, const double max_diff)
-    : m_median(std::nullopt),
-      m_min_valid(min_value),
+    : m_min_valid(min_value),
       m_max_valid(max_value),
       m_max_diff(max_diff)
   {
     m_buffer.set_capacity(buffer_length);
-    m_buffer_sorted.reserve(buffer_length);
   }
 
   MedianFilter::MedianFilter()
-    : m_median(std::nullopt),
-      m_min_valid(0.0),
+    : m_min_valid(0.0),
       m_max_valid(0.0),
       m_max_diff(0.0)
   {
@@ -41,8 +38,8 @@ namespace mrs_lib
     std::scoped_lock lck(other.m_mtx, m_mtx);
   
     m_buffer = other.m_buffer;
-    m_buffer_sorted = other.m_buffer_sorted;
-    m_median = other.m_median;
+    m_lower = other.m_lower;
+    m_upper = other.m_upper;
   
     // parameters specified by the user
     m_min_valid = other.m_min_valid;
@@ -57,8 +54,8 @@ namespace mrs_lib
     std::scoped_lock lck(other.m_mtx, m_mtx);
 
     m_buffer = std::move(other.m_buffer);
-    m_buffer_sorted = std::move(other.m_buffer_sorted);
-    m_median = std::move(other.m_median);
+    m_lower = std::move(other.m_lower);
+    m_upper = std::move(other.m_upper);
 
     // parameters specified by the user
     m_min_valid = other.m_min_valid;
@@ -73,10 +70,19 @@ namespace mrs_lib
   void MedianFilter::add(const double value)
   {
     std::scoped_lock lck(m_mtx);
+    // a zero-length buffer cannot hold any values
+    if (m_buffer.capacity() == 0)
+      return;
+
+    // if the buffer is full, the oldest value will be retired - its node is reused for the new value to avoid an allocation
+    sorted_t::node_type node;
+    if (m_buffer.full())
+      node = extractSorted(m_buffer.front());
     // add the value to the buffer
     m_buffer.push_back(value);
-    // reset the cached median value
-    m_median = std::nullopt;
+    // add the value to the sorted halves and keep them balanced
+    insertSorted(value, std::move(node));
+    rebalanceSorted();
   }
   //}
 
@@ -103,8 +109,9 @@ namespace mrs_lib
   void MedianFilter::clear()
   {
     std::scoped_lock lck(m_mtx);
-    m_median = std::nullopt;
     m_buffer.clear();
+    m_lower.clear();
+    m_upper.clear();
   }
   //}
 
@@ -120,37 +127,16 @@ namespace mrs_lib
   double MedianFilter::median() const
   {
     std::scoped_lock lck(m_mtx);
-    // if the value was already calculated, just return it
-    if (m_median.has_value())
-      return m_median.value();
-  
     // check if there are even any numbers to calculate the median from
     if (m_buffer.empty())
-    {
-      m_median = std::numeric_limits<double>::quiet_NaN();
-      return m_median.value();
-    }
-  
-    // remove any elements from buffer_sorted
-    m_buffer_sorted.clear();
-    // copy all elements from the input buffer to buffer_sorted
-    m_buffer_sorted.insert(std::end(m_buffer_sorted), std::begin(m_buffer), std::end(m_buffer));
-    // check for the special case of the median when there is an even number of numbers in the set
-    const bool even_set = m_buffer_sorted.size() % 2 == 0;
-  
-    // if it's an even set, we'll need one more element sorted than for an odd set of numbers
-    const size_t median_pos = even_set ? std::ceil(m_buffer_sorted.size()/2.0) : std::floor(m_buffer_sorted.size()/2.0);
-    // actually sort the elements in buffer_sorted up to the n-th element
-    std::nth_element(std::begin(m_buffer_sorted), std::begin(m_buffer_sorted)+median_pos, std::end(m_buffer_sorted));
-  
+      return std::numeric_limits<double>::quiet_NaN();
+
+    // the "normal" case with an odd set - the middle value is the largest one in the lower half
+    if (m_lower.size() > m_upper.size())
+      return *std::rbegin(m_lower);
     // special case for a median of an even set of numbers
-    if (even_set)
-      m_median = (m_buffer_sorted.at(median_pos) + m_buffer_sorted.at(median_pos-1))/2.0;
-    // the "normal" case with an odd set
     else
-      m_median = m_buffer_sorted.at(median_pos);
-    // return the now-cached value
-    return m_median.value();
+      return (*std::rbegin(m_lower) + *std::begin(m_upper))/2.0;
   }
   //}
 
@@ -167,11 +153,11 @@ namespace mrs_lib
   {
     std::scoped_lock lck(m_mtx);
     // the median may change if the some values are discarded
-    if (buffer_length < m_buffer.size())
-      m_median = std::nullopt;
+    const bool discarded = buffer_length < m_buffer.size();
   
     m_buffer.set_capacity(buffer_length);
-    m_buffer_sorted.reserve(buffer_length);
+    if (discarded)
+      rebuildSorted();
   }
   //}
 
@@ -199,4 +185,55 @@ namespace mrs_lib
   }
   //}
 
+  /* extractSorted() method //{ */
+  // removes one occurence of the value (which must be in the buffer) from the sorted halves
+  MedianFilter::sorted_t::node_type MedianFilter::extractSorted(const double value)
+  {
+    // all values in the upper half are larger or equal to the largest one in the lower half
+    sorted_t& half = less_t()(*std::rbegin(m_lower), value) ? m_upper : m_lower;
+    return half.extract(half.find(value));
+  }
+  //}
+
+  /* insertSorted() method //{ */
+  // adds the value to the corresponding sorted half (reusing the node if it is not empty)
+  void MedianFilter::insertSorted(const double value, sorted_t::node_type&& node)
+  {
+    sorted_t& half = !m_lower.empty() && less_t()(*std::rbegin(m_lower), value) ? m_upper : m_lower;
+    if (node.empty())
+    {
+      half.insert(value);
+    }
+    else
+    {
+      node.value() = value;
+      half.insert(std::move(node));
+    }
+  }
+  //}
+
+  /* rebalanceSorted() method //{ */
+  // moves values between the sorted halves so that the lower half has the same number of values or one more than the upper half
+  void MedianFilter::rebalanceSorted()
+  {
+    while (m_lower.size() > m_upper.size() + 1)
+      m_upper.insert(m_lower.extract(std::prev(std::end(m_lower))));
+    while (m_upper.size() > m_lower.size())
+      m_lower.insert(m_upper.extract(std::begin(m_upper)));
+  }
+  //}
+
+  /* rebuildSorted() method //{ */
+  void MedianFilter::rebuildSorted()
+  {
+    m_lower.clear();
+    m_upper.clear();
+    for (const double value : m_buffer)
+    {
+      insertSorted(value, {});
+      rebalanceSorted();
+    }
+  }
+  //}
+
 } // namespace mrs_lib
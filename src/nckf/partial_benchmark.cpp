@@ -0,0 +1,82 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the partially norm-constrained LKF with runtime and compile-time indices
+     \author Matouš Vrba - vrbamato@fel.cvut.cz
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib nckf_partial_benchmark`.
+     It compares the mean duration of one correction of the NCLKF_partial (with the indices of the norm-constrained
+     states specified at runtime) and of the NCLKF_partial_static (with the indices specified at compile time) for a 9-state
+     attitude model, where a 3D vector is norm-constrained, with contiguous and non-contiguous indices.
+ */
+
+#include <mrs_lib/nckf.h>
+#include <chrono>
+#include <iostream>
+
+namespace mrs_lib
+{
+  const int n_states = 9;
+  const int n_inputs = 3;
+  const int n_measurements = 3;
+  const int n_states_norm_constrained = 3;
+
+  using nclkf_t = NCLKF_partial<n_states, n_inputs, n_measurements, n_states_norm_constrained>;
+}
+
+using namespace mrs_lib;
+using A_t = nclkf_t::A_t;
+using B_t = nclkf_t::B_t;
+using H_t = nclkf_t::H_t;
+using x_t = nclkf_t::x_t;
+using P_t = nclkf_t::P_t;
+using z_t = nclkf_t::z_t;
+using R_t = nclkf_t::R_t;
+using statecov_t = nclkf_t::statecov_t;
+
+/* measure() function //{ */
+// returns the mean duration of one correction in nanoseconds
+template <typename KF>
+double measure(const KF& kf, const int n_its)
+{
+  const P_t P_tmp = P_t::Random();
+  const statecov_t sc{x_t::Random(), P_tmp * P_tmp.transpose() + P_t::Identity()};
+  const z_t z = z_t::Random();
+  const R_t R = R_t::Identity();
+  double x_sum = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int it = 0; it < n_its; it++)
+    x_sum += kf.correct(sc, z, R).x.sum();
+  const std::chrono::duration<double, std::nano> dur = std::chrono::steady_clock::now() - start;
+  // print the state to prevent the compiler from optimizing the loop away
+  if (!std::isfinite(x_sum))
+    std::cerr << "the state is not finite" << std::endl;
+  return dur.count() / n_its;
+}
+//}
+
+int main()
+{
+  const int n_its = 1000000;
+  // the measurement is a linear combination of all the states
+  const A_t A = A_t::Identity();
+  const B_t B = B_t::Zero();
+  const H_t H = H_t::Random();
+  const double l = 1.0;
+
+  std::cout << "indices\t\truntime [ns]\tstatic [ns]\tspeedup [-]" << std::endl;
+  {
+    const nclkf_t nclkf(A, B, H, l, {3, 4, 5});
+    const NCLKF_partial_static<n_states, n_inputs, n_measurements, 3, 4, 5> nclkf_static(A, B, H, l);
+    const double dur = measure(nclkf, n_its);
+    const double dur_static = measure(nclkf_static, n_its);
+    std::cout << "3, 4, 5\t\t" << dur << "\t\t" << dur_static << "\t\t" << dur / dur_static << std::endl;
+  }
+  {
+    const nclkf_t nclkf(A, B, H, l, {0, 3, 6});
+    const NCLKF_partial_static<n_states, n_inputs, n_measurements, 0, 3, 6> nclkf_static(A, B, H, l);
+    const double dur = measure(nclkf, n_its);
+    const double dur_static = measure(nclkf_static, n_its);
+    std::cout << "0, 3, 6\t\t" << dur << "\t\t" << dur_static << "\t\t" << dur / dur_static << std::endl;
+  }
+  return 0;
+}
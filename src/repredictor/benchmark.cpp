@@ -0,0 +1,179 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the Repredictor implementation
+     \author Matouš Vrba - vrbamato@fel.cvut.cz
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib repredictor_benchmark`.
+     It reports the memory used by one element of the history buffer and the latency of adding new data to the buffer.
+     It also compares adding bursts of delayed measurements to the Repredictor one by one using addMeasurement()
+     and at once using addMeasurements().
+ */
+
+// Include the Repredictor header
+#include <mrs_lib/repredictor.h>
+// As a model, we'll use a LKF variant
+#include <mrs_lib/lkf.h>
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+// Define the LKF we will be using
+namespace mrs_lib
+{
+  const int n_states = 2;
+  const int n_inputs = 1;
+  const int n_measurements = 1;
+
+  using lkf_t = varstepLKF<n_states, n_inputs, n_measurements>;
+  using rep_t = Repredictor<lkf_t>;
+}
+
+/* helper aliases and definitions //{ */
+
+// Some helpful aliases to make writing of types shorter
+using namespace mrs_lib;
+using A_t = lkf_t::A_t;
+using B_t = lkf_t::B_t;
+using H_t = lkf_t::H_t;
+using Q_t = lkf_t::Q_t;
+using x_t = lkf_t::x_t;
+using P_t = lkf_t::P_t;
+using u_t = lkf_t::u_t;
+using z_t = lkf_t::z_t;
+using R_t = lkf_t::R_t;
+
+static std::mt19937 gen{0};
+static std::uniform_real_distribution<> ud{0, 1};
+
+A_t generateA(const double dt)
+{
+  A_t A;
+  A << 1, dt,
+       0, 1;
+  return A;
+}
+
+B_t generateB([[maybe_unused]] const double dt)
+{
+  B_t B;
+  B << dt*dt/2.0,
+       dt;
+  return B;
+}
+
+const Q_t Q = 2.5*Q_t::Identity();
+const H_t H( (H_t() << 1, 0).finished() );
+const R_t R = 0.01*R_t::Identity();
+
+const x_t x0 = x_t::Zero();
+const P_t P0 = 5.0*P_t::Identity();
+const u_t u0 = u_t::Zero();
+const ros::Time t0 = ros::Time(0);
+
+//}
+
+// helper struct to get the size of one element of the history buffer
+struct rep_info_size_t : public rep_t
+{
+  static constexpr size_t value = sizeof(typename rep_t::history_t::value_type);
+};
+
+/* run_insertion() function //{ */
+// runs the benchmark and returns the mean duration of adding one input or measurement to a full history buffer in nanoseconds
+double run_insertion(const unsigned hist_len, const unsigned n_adds)
+{
+  const auto lkf_ptr = std::make_shared<lkf_t>(generateA, generateB, H);
+  rep_t rep(x0, P0, u0, Q, t0, lkf_ptr, hist_len);
+
+  // fill the history buffer with inputs and measurements at 100Hz
+  const double dt = 0.01;
+  ros::Time stamp = t0;
+  for (unsigned it = 0; it < hist_len; it++)
+  {
+    stamp += ros::Duration(dt);
+    rep.addInputChangeWithNoise(u_t::Random(), Q, stamp);
+  }
+
+  const u_t u = u_t::Random();
+  const z_t z = z_t::Random();
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned it = 0; it < n_adds; it++)
+  {
+    stamp += ros::Duration(dt);
+    if (it % 2)
+      rep.addMeasurement(z, R, stamp);
+    else
+      rep.addInputChangeWithNoise(u, Q, stamp);
+  }
+  const std::chrono::duration<double, std::nano> dur = std::chrono::steady_clock::now() - start;
+  return dur.count()/n_adds;
+}
+//}
+
+/* run() function //{ */
+// runs the benchmark and returns the mean durations of adding one burst of measurements and of the subsequent reprediction in microseconds
+std::pair<double, double> run(const unsigned hist_len, const unsigned burst_len, const unsigned n_bursts, const bool batched)
+{
+  const auto lkf_ptr = std::make_shared<lkf_t>(generateA, generateB, H);
+  rep_t rep(x0, P0, u0, Q, t0, lkf_ptr, hist_len);
+
+  // fill the history buffer with inputs at 100Hz
+  const double dt = 0.01;
+  ros::Time stamp = t0;
+  for (unsigned it = 0; it < hist_len; it++)
+  {
+    stamp += ros::Duration(dt);
+    rep.addInputChangeWithNoise(u_t::Random(), Q, stamp);
+  }
+  rep.predictTo(stamp);
+
+  std::chrono::duration<double, std::micro> add_dur(0);
+  std::chrono::duration<double, std::micro> predict_dur(0);
+  std::vector<rep_t::measurement_t> meass(burst_len);
+  for (unsigned burst_it = 0; burst_it < n_bursts; burst_it++)
+  {
+    // add an input and a burst of measurements, delayed by up to a quarter of the time span of the history buffer
+    stamp += ros::Duration(dt);
+    rep.addInputChangeWithNoise(u_t::Random(), Q, stamp);
+    for (auto& meas : meass)
+      meas = {z_t::Random(), R, stamp - ros::Duration(ud(gen)*dt*hist_len/(4.0*(burst_len + 1)))};
+
+    const auto start = std::chrono::steady_clock::now();
+    if (batched)
+    {
+      rep.addMeasurements(meass);
+    }
+    else
+    {
+      for (const auto& meas : meass)
+        rep.addMeasurement(meas.z, meas.R, meas.stamp);
+    }
+    const auto added = std::chrono::steady_clock::now();
+    rep.predictTo(stamp);
+    predict_dur += std::chrono::steady_clock::now() - added;
+    add_dur += added - start;
+  }
+  return {add_dur.count()/n_bursts, predict_dur.count()/n_bursts};
+}
+//}
+
+int main()
+{
+  std::cout << "history buffer element size: " << rep_info_size_t::value << "B" << std::endl;
+  for (const unsigned hist_len : {100, 2000})
+    std::cout << "insertion latency (hist_len " << hist_len << "): " << run_insertion(hist_len, 100000) << "ns" << std::endl;
+
+  const unsigned n_bursts = 1000;
+  std::cout << "hist_len\tburst_len\tsingle add [us]\tbatched add [us]\tsingle predict [us]\tbatched predict [us]" << std::endl;
+  for (const unsigned hist_len : {100, 500, 2000})
+  {
+    for (const unsigned burst_len : {1, 5, 20, 50})
+    {
+      const auto [add_single, predict_single] = run(hist_len, burst_len, n_bursts, false);
+      const auto [add_batched, predict_batched] = run(hist_len, burst_len, n_bursts, true);
+      std::cout << hist_len << "\t\t" << burst_len << "\t\t" << add_single << "\t\t" << add_batched << "\t\t" << predict_single << "\t\t" << predict_batched << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,93 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the RHEIV fitting for large numbers of data points
+     \author Matouš Vrba - vrbamato@fel.cvut.cz
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib rheiv_fit_benchmark`.
+     It measures the mean duration of RHEIV::fit() for a plane fitted to 1e3 to 1e6 noisy 3D points with serial
+     and parallel evaluation (see RHEIV::set_parallel_evaluation()) to find the crossover point, from which
+     the parallel evaluation pays off.
+ */
+
+#include <mrs_lib/rheiv.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace mrs_lib
+{
+  const int n_states = 3;
+  const int n_params = 4;
+
+  using rheiv_t = RHEIV<n_states, n_params>;
+}
+
+using namespace mrs_lib;
+using xs_t = rheiv_t::xs_t;
+using zs_t = rheiv_t::zs_t;
+using P_t = rheiv_t::P_t;
+using Ps_t = rheiv_t::Ps_t;
+using dzdx_t = rheiv_t::dzdx_t;
+
+// for the plane surface model, there is no need to transform the data
+zs_t f_z(const xs_t& xs)
+{
+  return xs;
+}
+
+/* run() function //{ */
+// returns the mean duration of one fit in milliseconds
+double run(const int n_threads, const xs_t& xs, const Ps_t& Ps, const int n_its)
+{
+  const dzdx_t dzdx = dzdx_t::Identity();
+  rheiv_t rheiv(f_z, dzdx, 1e-15, 100u);
+  rheiv.set_parallel_evaluation(n_threads);
+
+  double th_sum = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int it = 0; it < n_its; it++)
+    th_sum += rheiv.fit(xs, Ps).sum();
+  const std::chrono::duration<double, std::milli> dur = std::chrono::steady_clock::now() - start;
+  // print the result to prevent the compiler from optimizing the loop away
+  if (!std::isfinite(th_sum))
+    std::cerr << "the estimate is not finite" << std::endl;
+  return dur.count() / n_its;
+}
+//}
+
+int main()
+{
+  const std::vector<int> n_threads = {1, 2, 4, 8};
+  std::cout << "points";
+  for (const int n_thr : n_threads)
+    std::cout << "\t\t" << n_thr << " thr. [ms]";
+  std::cout << std::endl;
+
+  // noisy samples of the plane 0.3x - 0.2y + z - 5 = 0
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<> pos(-10.0, 10.0);
+  std::normal_distribution<> noise(0.0, 0.1);
+  for (const int n_pts : {1000, 10000, 100000, 1000000})
+  {
+    xs_t xs(n_states, n_pts);
+    Ps_t Ps;
+    Ps.reserve(n_pts);
+    for (int it = 0; it < n_pts; it++)
+    {
+      const double x = pos(gen);
+      const double y = pos(gen);
+      xs.col(it) << x, y, 5.0 - 0.3 * x + 0.2 * y + noise(gen);
+      Ps.push_back(0.01 * P_t::Identity());
+    }
+
+    const int n_its = std::max(3, 10000000 / n_pts);
+    std::cout << n_pts;
+    for (const int n_thr : n_threads)
+      std::cout << "\t\t" << run(n_thr, xs, Ps, n_its);
+    std::cout << std::endl;
+  }
+  return 0;
+}
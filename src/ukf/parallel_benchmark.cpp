@@ -0,0 +1,89 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the parallel evaluation of the sigma points in the UKF
+     \author Matouš Vrba - vrbamato@fel.cvut.cz
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib ukf_parallel_benchmark`.
+     It compares the mean duration of the correction step of the UKF with serial and parallel evaluation of the observation
+     model (see UKF::setParallelEvaluation()) for observation models of different costs, to find the crossover point, from which
+     the parallel evaluation pays off.
+ */
+
+#include <mrs_lib/ukf.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Define the UKF we will be using - 15 states give 31 sigma points
+namespace mrs_lib
+{
+  const int n_states = 15;
+  const int n_inputs = 1;
+  const int n_measurements = 3;
+
+  using ukf_t = UKF<n_states, n_inputs, n_measurements>;
+}
+
+using namespace mrs_lib;
+using x_t = ukf_t::x_t;
+using u_t = ukf_t::u_t;
+using z_t = ukf_t::z_t;
+using P_t = ukf_t::P_t;
+using R_t = ukf_t::R_t;
+using statecov_t = ukf_t::statecov_t;
+
+x_t tra_model_f(const x_t& x, [[maybe_unused]] const u_t& u, [[maybe_unused]] const double dt)
+{
+  return x;
+}
+
+/* run() function //{ */
+// returns the mean duration of one correction in microseconds for an observation model with n_ops operations
+double run(const int n_threads, const int n_ops, const int n_its)
+{
+  // the cost of the model is simulated by a loop of trigonometric functions (eg. a ray-casting step)
+  const auto obs_model_f = [n_ops](const x_t& x) {
+    z_t ret = x.head<n_measurements>();
+    for (int it = 0; it < n_ops; it++)
+      ret(it % n_measurements) += 1e-9 * std::sin(ret(it % n_measurements) + it);
+    return ret;
+  };
+
+  ukf_t ukf(tra_model_f, obs_model_f);
+  ukf.setParallelEvaluation(n_threads);
+
+  const statecov_t sc{x_t::Zero(), P_t::Identity()};
+  const z_t z = z_t::Ones();
+  const R_t R = R_t::Identity();
+  double x_sum = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int it = 0; it < n_its; it++)
+    x_sum += ukf.correct(sc, z, R).x.sum();
+  const std::chrono::duration<double, std::micro> dur = std::chrono::steady_clock::now() - start;
+  // print the state to prevent the compiler from optimizing the loop away
+  if (!std::isfinite(x_sum))
+    std::cerr << "the state is not finite" << std::endl;
+  return dur.count() / n_its;
+}
+//}
+
+int main()
+{
+  const std::vector<int> n_threads = {1, 2, 4, 8};
+  std::cout << "model ops";
+  for (const int n_thr : n_threads)
+    std::cout << "\t" << n_thr << " thr. [us]";
+  std::cout << std::endl;
+
+  for (const int n_ops : {1, 10, 100, 1000, 10000, 100000})
+  {
+    const int n_its = std::max(10, 1000000 / (n_ops * ukf_t::X_t::ColsAtCompileTime));
+    std::cout << n_ops;
+    for (const int n_thr : n_threads)
+      std::cout << "\t\t" << run(n_thr, n_ops, n_its);
+    std::cout << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+// clang: MatousFormat
+/**  \file
+     \brief Benchmark of the covariance reductions over the sigma points in the UKF
+     \author Matouš Vrba - vrbamato@fel.cvut.cz
+
+     This benchmark may be run after building *mrs_lib* by executing `rosrun mrs_lib ukf_reduction_benchmark`.
+     It compares the mean duration of the computation of the predicted covariance \f$ \mathbf{P} \f$ and of the covariances
+     \f$ \mathbf{P}_{zz} \f$ and \f$ \mathbf{P}_{xz} \f$ from the sigma points using a sum of rank-1 updates (the original implementation)
+     and using weighted matrix products over the deviation matrices (the current implementation of UKF::predict() and UKF::correct())
+     for the numbers of states and measurements typically used.
+ */
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+/* reductions_t struct //{ */
+// the reductions for one combination of the number of states n and the number of measurements p
+template <int n, int p>
+struct reductions_t
+{
+  static constexpr int w = 2 * n + 1;
+  using x_t = Eigen::Matrix<double, n, 1>;
+  using z_t = Eigen::Matrix<double, p, 1>;
+  using P_t = Eigen::Matrix<double, n, n>;
+  using Pzz_t = Eigen::Matrix<double, p, p>;
+  using K_t = Eigen::Matrix<double, n, p>;
+  using W_t = Eigen::Matrix<double, w, 1>;
+  using X_t = Eigen::Matrix<double, n, w>;
+  using Z_t = Eigen::Matrix<double, p, w>;
+
+  // the original implementation - one rank-1 update per sigma point
+  static void loop(const X_t& X, const Z_t& Z, const x_t& x, const z_t& z, const W_t& Wc, P_t& P, Pzz_t& Pzz, K_t& Pxz)
+  {
+    P = P_t::Zero();
+    for (int i = 0; i < w; i++)
+      P += Wc(i) * (X.col(i) - x) * (X.col(i) - x).transpose();
+    Pzz = Pzz_t::Zero();
+    for (int i = 0; i < w; i++)
+      Pzz += Wc(i) * (Z.col(i) - z) * (Z.col(i) - z).transpose();
+    Pxz = K_t::Zero();
+    for (int i = 0; i < w; i++)
+      Pxz += Wc(i) * (X.col(i) - x) * (Z.col(i) - z).transpose();
+  }
+
+  // the current implementation - weighted products of the deviation matrices
+  static void gemm(const X_t& X, const Z_t& Z, const x_t& x, const z_t& z, const W_t& Wc, P_t& P, Pzz_t& Pzz, K_t& Pxz)
+  {
+    const X_t X_dev = X.colwise() - x;
+    P.noalias() = X_dev * Wc.asDiagonal() * X_dev.transpose();
+    const Z_t Z_dev = Z.colwise() - z;
+    const Z_t Z_dev_w = Z_dev * Wc.asDiagonal();
+    Pzz.noalias() = Z_dev_w * Z_dev.transpose();
+    Pxz.noalias() = X_dev * Z_dev_w.transpose();
+  }
+
+  // returns the mean duration of one evaluation of the reductions in nanoseconds
+  template <typename F>
+  static double measure(F fun, const int n_its)
+  {
+    const X_t X = X_t::Random();
+    const Z_t Z = Z_t::Random();
+    const x_t x = X.rowwise().mean();
+    const z_t z = Z.rowwise().mean();
+    const W_t Wc = W_t::Random();
+    P_t P;
+    Pzz_t Pzz;
+    K_t Pxz;
+    double sum = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < n_its; it++)
+    {
+      fun(X, Z, x, z, Wc, P, Pzz, Pxz);
+      sum += P(0, 0) + Pzz(0, 0) + Pxz(0, 0);
+    }
+    const std::chrono::duration<double, std::nano> dur = std::chrono::steady_clock::now() - start;
+    // print the result to prevent the compiler from optimizing the loop away
+    if (!std::isfinite(sum))
+      std::cerr << "the result is not finite" << std::endl;
+    return dur.count() / n_its;
+  }
+
+  static void run()
+  {
+    const int n_its = std::max(1000, 100000000 / (n * n * w));
+    const double dur_loop = measure(loop, n_its);
+    const double dur_gemm = measure(gemm, n_its);
+    std::cout << n << "\t" << p << "\t" << dur_loop << "\t\t" << dur_gemm << "\t\t" << dur_loop / dur_gemm << std::endl;
+  }
+};
+//}
+
+/* run_all() function //{ */
+template <int n, int... ps>
+void run_ps(std::integer_sequence<int, ps...>)
+{
+  (reductions_t<n, ps + 1>::run(), ...);
+}
+
+template <int... ns>
+void run_all(std::integer_sequence<int, ns...>)
+{
+  // n = 6, 12, 18, 24 and p = 1..6
+  (run_ps<6 * (ns + 1)>(std::make_integer_sequence<int, 6>()), ...);
+}
+//}
+
+int main()
+{
+  std::cout << "n\tp\tloop [ns]\tgemm [ns]\tspeedup [-]" << std::endl;
+  run_all(std::make_integer_sequence<int, 4>());
+  return 0;
+}
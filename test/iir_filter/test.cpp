@@ -0,0 +1,119 @@
+#include <mrs_lib/iir_filter.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// a second-order low-pass Butterworth filter (cutoff at 0.1 of the sampling frequency)
+const std::vector<double> a = {1.0, -1.142980502539901, 0.412801598096189};
+const std::vector<double> b = {0.067455273889072, 0.134910547778144, 0.067455273889072};
+
+/* class ReferenceDf2 //{ */
+
+// the direct form II with a shifted delay line (the original implementation of IirFilter::iterate())
+class ReferenceDf2 {
+
+public:
+  double iterate(const double input) {
+
+    buffer_[0]    = input;
+    double output = 0;
+    for (size_t i = 1; i < a.size(); i++) {
+      buffer_[0] += (-a[i]) * buffer_[i];
+      output += b[i] * buffer_[i];
+    }
+    output += buffer_[0] * b[0];
+    for (size_t i = a.size() - 1; i > 0; i--) {
+      buffer_[i] = buffer_[i - 1];
+    }
+    return output;
+  }
+
+private:
+  std::vector<double> buffer_ = std::vector<double>(a.size(), 0.0);
+};
+
+//}
+
+/* TEST(TESTSuite, single_channel) //{ */
+
+TEST(TESTSuite, single_channel) {
+
+  mrs_lib::IirFilter        fil(a, b);
+  mrs_lib::IirFilterN<2, 1> fil_n({a[0], a[1], a[2]}, {b[0], b[1], b[2]});
+  ReferenceDf2              reference;
+
+  std::mt19937                     gen(42);
+  std::uniform_real_distribution<> rand_val(-1.0, 1.0);
+  for (int it = 0; it < 1000; it++) {
+    const double input = rand_val(gen);
+    const double ref   = reference.iterate(input);
+    EXPECT_NEAR(fil.iterate(input), ref, 1e-12);
+    EXPECT_NEAR(fil_n.iterate(mrs_lib::IirFilterN<2, 1>::vec_t::Constant(input))(0), ref, 1e-12);
+  }
+
+  // the DC gain of the low-pass filter is one
+  double output = 0;
+  for (int it = 0; it < 1000; it++) {
+    output = fil.iterate(1.0);
+  }
+  EXPECT_NEAR(output, 1.0, 1e-9);
+}
+
+//}
+
+/* TEST(TESTSuite, block_processing) //{ */
+
+TEST(TESTSuite, block_processing) {
+
+  using fil_t = mrs_lib::IirFilterN<2, 6>;
+  // the coefficients are normalized by a[0]
+  const fil_t::coeffs_t a_n = {2.0 * a[0], 2.0 * a[1], 2.0 * a[2]};
+  const fil_t::coeffs_t b_n = {2.0 * b[0], 2.0 * b[1], 2.0 * b[2]};
+
+  fil_t fil_iterate(a_n, b_n);
+  fil_t fil_block(a_n, b_n);
+  fil_t fil_inplace(a_n, b_n);
+  fil_t fil_ptr(a_n, b_n);
+
+  const int              n_samples = 100;
+  const fil_t::samples_t in        = fil_t::samples_t::Random(6, n_samples);
+  fil_t::samples_t       out_iterate(6, n_samples);
+  fil_t::samples_t       out_block(6, n_samples);
+  fil_t::samples_t       out_inplace = in;
+  std::vector<double>    out_ptr(in.data(), in.data() + in.size());
+
+  // the samples are processed in several blocks of different lengths to check that the state is kept between them
+  for (int it = 0; it < n_samples; it++) {
+    out_iterate.col(it) = fil_iterate.iterate(in.col(it));
+  }
+  fil_block.process(in.leftCols(30), out_block.leftCols(30));
+  fil_block.process(in.rightCols(70), out_block.rightCols(70));
+  fil_inplace.process(out_inplace, out_inplace);
+  fil_ptr.process(out_ptr.data(), out_ptr.data(), 50);
+  fil_ptr.process(out_ptr.data() + 6 * 50, out_ptr.data() + 6 * 50, 50);
+
+  EXPECT_TRUE(out_block.isApprox(out_iterate, 1e-12));
+  EXPECT_TRUE(out_inplace.isApprox(out_iterate, 1e-12));
+  EXPECT_TRUE(Eigen::Map<const fil_t::samples_t>(out_ptr.data(), 6, n_samples).isApprox(out_iterate, 1e-12));
+
+  // each channel is filtered independently
+  mrs_lib::IirFilter fil(a, b);
+  for (int it = 0; it < n_samples; it++) {
+    EXPECT_NEAR(fil.iterate(in(3, it)), out_iterate(3, it), 1e-12);
+  }
+
+  fil_block.reset();
+  fil_block.process(in, out_block);
+  EXPECT_TRUE(out_block.isApprox(out_iterate, 1e-12));
+}
+
+//}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
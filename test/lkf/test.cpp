@@ -0,0 +1,531 @@
+// clang: MatousFormat
+
+#include <mrs_lib/lkf.h>
+#include <mrs_lib/nckf.h>
+#include <mrs_lib/batch_lkf.h>
+#include <mrs_lib/dkf.h>
+#include <mrs_lib/jlkf.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <gtest/gtest.h>
+#include <log4cxx/logger.h>
+
+namespace mrs_lib
+{
+  const int n_states = 6;
+  const int n_inputs = 1;
+  const int n_measurements = 2;
+
+  using lkf_t = LKF<n_states, n_inputs, n_measurements>;
+  using sqrtlkf_t = sqrtLKF<n_states, n_inputs, n_measurements>;
+  using nclkf_t = NCLKF<n_states, n_inputs, n_measurements>;
+  using batchlkf_t = batchLKF<n_states, n_inputs, n_measurements>;
+  using varsteplkf_t = varstepLKF<n_states, n_inputs, n_measurements>;
+  using dkf_t = DKF<n_states, n_inputs>;
+}  // namespace mrs_lib
+
+using namespace mrs_lib;
+using A_t = lkf_t::A_t;
+using B_t = lkf_t::B_t;
+using H_t = lkf_t::H_t;
+using Q_t = lkf_t::Q_t;
+using x_t = lkf_t::x_t;
+using P_t = lkf_t::P_t;
+using u_t = lkf_t::u_t;
+using z_t = lkf_t::z_t;
+using R_t = lkf_t::R_t;
+using statecov_t = lkf_t::statecov_t;
+
+template class mrs_lib::sqrtLKF<n_states, n_inputs, n_measurements>;
+
+// a random symmetric positive definite matrix
+template <int rows>
+Eigen::Matrix<double, rows, rows> random_spd(const double scale)
+{
+  const Eigen::Matrix<double, rows, rows> tmp = Eigen::Matrix<double, rows, rows>::Random();
+  return scale * (tmp * tmp.transpose() + 0.1 * Eigen::Matrix<double, rows, rows>::Identity());
+}
+
+// a constant acceleration model of a 2D point
+void generate_system(A_t& A, B_t& B, H_t& H, const double dt)
+{
+  A.setIdentity();
+  for (int it = 0; it < 2; it++)
+  {
+    A(it, it + 2) = dt;
+    A(it, it + 4) = dt * dt / 2.0;
+    A(it + 2, it + 4) = dt;
+  }
+  B.setZero();
+  B(4) = dt;
+  H.setZero();
+  H(0, 0) = H(1, 1) = 1.0;
+}
+
+/* TEST(TESTSuite, sqrt_lkf_comparison) //{ */
+
+TEST(TESTSuite, sqrt_lkf_comparison)
+{
+  const double dt = 0.1;
+  A_t A;
+  B_t B;
+  H_t H;
+  generate_system(A, B, H, dt);
+
+  const lkf_t lkf(A, B, H);
+  const sqrtlkf_t sqrtlkf(A, B, H);
+
+  statecov_t sc{x_t::Random(), random_spd<n_states>(10.0)};
+  auto sqrt_sc = sqrtlkf_t::toSqrt(sc);
+  // the conversion should not change the covariance
+  EXPECT_NEAR((sqrtlkf_t::fromSqrt(sqrt_sc).P - sc.P).norm(), 0.0, 1e-9);
+
+  for (int it = 0; it < 100; it++)
+  {
+    const u_t u = u_t::Random();
+    const Q_t Q = random_spd<n_states>(0.1);
+    const z_t z = z_t::Random();
+    const R_t R = random_spd<n_measurements>(0.1);
+
+    sc = lkf.predict(sc, u, Q, dt);
+    sqrt_sc = sqrtlkf.predict(sqrt_sc, u, Q, dt);
+    sc = lkf.correct(sc, z, R);
+    sqrt_sc = sqrtlkf.correct(sqrt_sc, z, R);
+
+    const statecov_t cmp = sqrtlkf_t::fromSqrt(sqrt_sc);
+    EXPECT_NEAR((cmp.x - sc.x).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((cmp.P - sc.P).norm(), 0.0, 1e-6);
+  }
+
+  // the KalmanFilter interface should give the same results
+  const u_t u = u_t::Random();
+  const Q_t Q = random_spd<n_states>(0.1);
+  const z_t z = z_t::Random();
+  const R_t R = random_spd<n_measurements>(0.1);
+  const statecov_t sc_lkf = lkf.correct(lkf.predict(sc, u, Q, dt), z, R);
+  const statecov_t sc_sqrt = sqrtlkf.correct(sqrtlkf.predict(sc, u, Q, dt), z, R);
+  EXPECT_NEAR((sc_sqrt.x - sc_lkf.x).norm(), 0.0, 1e-6);
+  EXPECT_NEAR((sc_sqrt.P - sc_lkf.P).norm(), 0.0, 1e-6);
+}
+
+//}
+
+/* TEST(TESTSuite, sqrt_lkf_sequential) //{ */
+
+TEST(TESTSuite, sqrt_lkf_sequential)
+{
+  const double dt = 0.1;
+  A_t A;
+  B_t B;
+  H_t H;
+  generate_system(A, B, H, dt);
+
+  const sqrtlkf_t sqrtlkf(A, B, H);
+
+  // several low-dimensional measurements of a different length are applied using the same filter
+  const statecov_t sc{x_t::Random(), random_spd<n_states>(10.0)};
+  auto sqrt_sc = sqrtlkf_t::toSqrt(sc);
+
+  const Eigen::Matrix<double, 1, n_states> H1 = Eigen::Matrix<double, 1, n_states>::Random();
+  const Eigen::Matrix<double, 1, 1> z1 = Eigen::Matrix<double, 1, 1>::Random();
+  const Eigen::Matrix<double, 1, 1> R1 = random_spd<1>(0.1);
+  const Eigen::Matrix<double, 3, n_states> H3 = Eigen::Matrix<double, 3, n_states>::Random();
+  const Eigen::Matrix<double, 3, 1> z3 = Eigen::Matrix<double, 3, 1>::Random();
+  const Eigen::Matrix<double, 3, 3> R3 = random_spd<3>(0.1);
+  sqrt_sc = sqrtlkf.correct(sqrt_sc, z1, R1, H1);
+  sqrt_sc = sqrtlkf.correct(sqrt_sc, z3, R3, H3);
+
+  // applying both measurements at once using the LKF should give the same results
+  const LKF<n_states, n_inputs, 4> lkf4(A, B, (Eigen::Matrix<double, 4, n_states>() << H1, H3).finished());
+  Eigen::Matrix<double, 4, 4> R4 = Eigen::Matrix<double, 4, 4>::Zero();
+  R4.topLeftCorner<1, 1>() = R1;
+  R4.bottomRightCorner<3, 3>() = R3;
+  const auto sc4 = lkf4.correct({sc.x, sc.P}, (Eigen::Matrix<double, 4, 1>() << z1, z3).finished(), R4);
+
+  const statecov_t cmp = sqrtlkf_t::fromSqrt(sqrt_sc);
+  EXPECT_NEAR((cmp.x - sc4.x).norm(), 0.0, 1e-6);
+  EXPECT_NEAR((cmp.P - sc4.P).norm(), 0.0, 1e-6);
+}
+
+//}
+
+/* TEST(TESTSuite, sqrt_lkf_conditioning) //{ */
+
+TEST(TESTSuite, sqrt_lkf_conditioning)
+{
+  const double dt = 0.1;
+  A_t A;
+  B_t B;
+  H_t H;
+  generate_system(A, B, H, dt);
+  const sqrtlkf_t sqrtlkf(A, B, H);
+
+  // a very large initial uncertainty with very precise measurements and a singular process noise
+  auto sqrt_sc = sqrtlkf_t::toSqrt({x_t::Zero(), 1e8 * P_t::Identity()});
+  Q_t Q = Q_t::Zero();
+  Q(4, 4) = Q(5, 5) = 1e-6;
+  const R_t R = 1e-10 * R_t::Identity();
+
+  for (int it = 0; it < 1000; it++)
+  {
+    sqrt_sc = sqrtlkf.predict(sqrt_sc, u_t::Zero(), Q, dt);
+    sqrt_sc = sqrtlkf.correct(sqrt_sc, z_t::Random(), R);
+  }
+
+  // the covariance must stay symmetric and positive semi-definite
+  const P_t P = sqrtlkf_t::fromSqrt(sqrt_sc).P;
+  EXPECT_TRUE(P.allFinite());
+  EXPECT_NEAR((P - P.transpose()).norm(), 0.0, 1e-12);
+  const Eigen::SelfAdjointEigenSolver<P_t> es(P);
+  EXPECT_GE(es.eigenvalues().minCoeff(), -1e-12);
+}
+
+//}
+
+/* TEST(TESTSuite, sequential_correction) //{ */
+
+TEST(TESTSuite, sequential_correction)
+{
+  const double dt = 0.1;
+  A_t A;
+  B_t B;
+  H_t H;
+  generate_system(A, B, H, dt);
+  H.setRandom();
+
+  lkf_t lkf(A, B, H);
+  lkf_t lkf_seq(A, B, H);
+  lkf_seq.setSequentialCorrection(true);
+  nclkf_t nclkf(A, B, H, 3.0);
+  nclkf_t nclkf_seq(A, B, H, 3.0);
+  nclkf_seq.setSequentialCorrection(true);
+
+  for (int it = 0; it < 100; it++)
+  {
+    const statecov_t sc{x_t::Random(), random_spd<n_states>(10.0)};
+    const z_t z = z_t::Random();
+    const z_t R_diag = z_t::Random().cwiseAbs();
+    const R_t R = R_diag.asDiagonal();
+
+    const statecov_t sc_lkf = lkf.correct(sc, z, R);
+    const statecov_t sc_seq = lkf_seq.correct(sc, z, R);
+    const statecov_t sc_diag = lkf.correctDiagonal(sc, z, R_diag);
+    EXPECT_NEAR((sc_seq.x - sc_lkf.x).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((sc_seq.P - sc_lkf.P).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((sc_diag.x - sc_lkf.x).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((sc_diag.P - sc_lkf.P).norm(), 0.0, 1e-6);
+
+    const statecov_t sc_nclkf = nclkf.correct(sc, z, R);
+    const statecov_t sc_ncseq = nclkf_seq.correct(sc, z, R);
+    EXPECT_NEAR((sc_ncseq.x - sc_nclkf.x).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((sc_ncseq.P - sc_nclkf.P).norm(), 0.0, 1e-6);
+    EXPECT_NEAR(sc_ncseq.x.norm(), 3.0, 1e-9);
+  }
+
+  // a non-diagonal measurement noise covariance matrix is applied using the standard correction
+  const statecov_t sc{x_t::Random(), random_spd<n_states>(10.0)};
+  const z_t z = z_t::Random();
+  const R_t R = random_spd<n_measurements>(0.1);
+  EXPECT_NEAR((lkf_seq.correct(sc, z, R).P - lkf.correct(sc, z, R).P).norm(), 0.0, 1e-9);
+}
+
+//}
+
+/* TEST(TESTSuite, batch_lkf) //{ */
+
+TEST(TESTSuite, batch_lkf)
+{
+  const double dt = 0.1;
+  A_t A;
+  B_t B;
+  H_t H;
+  generate_system(A, B, H, dt);
+  // make the measurement correlated to test the decorrelation
+  H.setRandom();
+
+  const int n_filters = 17;
+  const lkf_t lkf(A, B, H);
+  batchlkf_t batchlkf(A, B, H, n_filters);
+  EXPECT_EQ(batchlkf.size(), n_filters);
+
+  std::vector<statecov_t> scs;
+  for (int f = 0; f < n_filters; f++)
+  {
+    scs.push_back({x_t::Random(), random_spd<n_states>(10.0)});
+    batchlkf.set(f, scs.back());
+  }
+
+  const Q_t Q = random_spd<n_states>(0.1);
+  const R_t R = random_spd<n_measurements>(0.1);
+  for (int it = 0; it < 50; it++)
+  {
+    const batchlkf_t::us_t us = batchlkf_t::us_t::Random(n_filters, n_inputs);
+    const batchlkf_t::zs_t zs = batchlkf_t::zs_t::Random(n_filters, n_measurements);
+    batchlkf.predict(us, Q, dt);
+    batchlkf.correct(zs, R);
+    for (int f = 0; f < n_filters; f++)
+    {
+      scs.at(f) = lkf.predict(scs.at(f), us.row(f).transpose(), Q, dt);
+      scs.at(f) = lkf.correct(scs.at(f), zs.row(f).transpose(), R);
+      const statecov_t sc = batchlkf.get(f);
+      EXPECT_NEAR((sc.x - scs.at(f).x).norm(), 0.0, 1e-6);
+      EXPECT_NEAR((sc.P - scs.at(f).P).norm(), 0.0, 1e-6);
+    }
+  }
+
+  // the same input for all filters
+  const u_t u = u_t::Random();
+  batchlkf.predict(u, Q, dt);
+  EXPECT_NEAR((batchlkf.get(3).x - lkf.predict(scs.at(3), u, Q, dt).x).norm(), 0.0, 1e-6);
+
+  // the kept filters should not be changed by resizing
+  batchlkf.resize(5);
+  EXPECT_EQ(batchlkf.size(), 5);
+  EXPECT_NEAR((batchlkf.get(3).x - lkf.predict(scs.at(3), u, Q, dt).x).norm(), 0.0, 1e-6);
+
+  EXPECT_THROW(batchlkf.correct(batchlkf_t::zs_t::Zero(5, n_measurements), -R), batchlkf_t::inverse_exception);
+}
+
+//}
+
+/* TEST(TESTSuite, varstep_lkf_cache) //{ */
+
+TEST(TESTSuite, varstep_lkf_cache)
+{
+  int n_generated = 0;
+  const auto generateA = [&n_generated](const double dt) {
+    A_t A;
+    B_t B;
+    H_t H;
+    generate_system(A, B, H, dt);
+    n_generated++;
+    return A;
+  };
+  const auto generateB = [](const double dt) {
+    A_t A;
+    B_t B;
+    H_t H;
+    generate_system(A, B, H, dt);
+    return B;
+  };
+  A_t A;
+  B_t B;
+  H_t H;
+  generate_system(A, B, H, 0.1);
+
+  // the closed-form constant acceleration model should be the same as the generated one
+  varsteplkf_t::polynomial_model_t model = varsteplkf_t::integratorModel(3);
+  model.coeff_B(4) = 1.0;
+  model.dtexp_B(4) = 1;
+  const varsteplkf_t lkf_poly(model, H);
+  EXPECT_NEAR((lkf_poly.getA(0.1) - A).norm(), 0.0, 1e-12);
+
+  varsteplkf_t lkf(generateA, generateB, H);
+  varsteplkf_t lkf_cached(generateA, generateB, H);
+  lkf_cached.setCache(1e-6, 3);
+
+  const Q_t Q = random_spd<n_states>(0.1);
+  const std::vector<double> dts = {0.01, 0.02, 0.01, 0.01 + 1e-7, 0.03, 0.02, 0.04, 0.01};
+  statecov_t sc{x_t::Random(), random_spd<n_states>(10.0)};
+  for (const double dt : dts)
+  {
+    const u_t u = u_t::Random();
+    const statecov_t sc_ref = lkf.predict(sc, u, Q, dt);
+    // the cached matrices may be generated for a slightly different time step (within the tolerance)
+    EXPECT_NEAR((lkf_cached.predict(sc, u, Q, dt).P - sc_ref.P).norm(), 0.0, 1e-4);
+    EXPECT_NEAR((lkf_poly.predict(sc, u, Q, dt).x - sc_ref.x).norm(), 0.0, 1e-9);
+    sc = sc_ref;
+  }
+
+  // the 0.04 step evicted the 0.01 one (the oldest in the full cache)
+  const auto stats = lkf_cached.getCacheStatistics();
+  EXPECT_EQ(stats.n_hits, 3u);
+  EXPECT_EQ(stats.n_misses, 5u);
+  EXPECT_EQ(n_generated, int(dts.size() + stats.n_misses));
+  lkf_cached.resetCacheStatistics();
+  EXPECT_EQ(lkf_cached.getCacheStatistics().n_hits, 0u);
+}
+
+//}
+
+/* TEST(TESTSuite, lkf_mrs_odom_steady_state) //{ */
+
+TEST(TESTSuite, lkf_mrs_odom_steady_state)
+{
+  using odom_t = LKF_MRS_odom;
+  const std::vector<odom_t::H_t> Hs = {(odom_t::H_t() << 1, 0, 0).finished(), (odom_t::H_t() << 0, 1, 0).finished()};
+  const odom_t lkf(Hs, 0.01);
+  odom_t lkf_ss(Hs, 0.01);
+  lkf_ss.setSteadyState(true, 1e-6, 1e-6);
+
+  const odom_t::Q_t Q = 0.1 * odom_t::Q_t::Identity();
+  const odom_t::R_t R = 0.01 * odom_t::R_t::Identity();
+  odom_t::statecov_t sc{odom_t::x_t::Zero(), odom_t::P_t::Identity()};
+  odom_t::statecov_t sc_ss = sc;
+  for (int it = 0; it < 2000; it++)
+  {
+    const odom_t::u_t u = odom_t::u_t::Random();
+    const odom_t::z_t z = odom_t::z_t::Random();
+    sc = lkf.correct(lkf.predict(sc, u, Q, 0.01), z, R, 0);
+    sc_ss = lkf_ss.correct(lkf_ss.predict(sc_ss, u, Q, 0.01), z, R, 0);
+  }
+  // after the covariance converges, both modes should give the same results
+  EXPECT_NEAR((sc_ss.x - sc.x).norm(), 0.0, 1e-6);
+  EXPECT_NEAR((sc_ss.P - sc.P).norm(), 0.0, 1e-6);
+
+  // a change of the time step falls back to the full update, which uses the passed covariance
+  const odom_t::u_t u = odom_t::u_t::Random();
+  const odom_t::z_t z = odom_t::z_t::Random();
+  const auto sc_ref = lkf.correct(lkf.predict(sc, u, Q, 0.02), z, 2.0 * R, 0);
+  sc_ss = lkf_ss.correct(lkf_ss.predict(sc, u, Q, 0.02), z, 2.0 * R, 0);
+  EXPECT_NEAR((sc_ss.x - sc_ref.x).norm(), 0.0, 1e-9);
+  EXPECT_NEAR((sc_ss.P - sc_ref.P).norm(), 0.0, 1e-9);
+}
+
+//}
+
+/* TEST(TESTSuite, nclkf_partial_static) //{ */
+
+TEST(TESTSuite, nclkf_partial_static)
+{
+  const double dt = 0.1;
+  A_t A;
+  B_t B;
+  H_t H;
+  generate_system(A, B, H, dt);
+  // the measurement has to depend on the norm-constrained states
+  H = H_t::Random();
+
+  // non-contiguous indices
+  {
+    const NCLKF_partial<n_states, n_inputs, n_measurements, 3> nclkf(A, B, H, 2.0, {1, 3, 5});
+    const NCLKF_partial_static<n_states, n_inputs, n_measurements, 1, 3, 5> nclkf_static(A, B, H, 2.0);
+    statecov_t sc{x_t::Random(), random_spd<n_states>(1.0)};
+    statecov_t sc_static = sc;
+    for (int it = 0; it < 20; it++)
+    {
+      const u_t u = u_t::Random();
+      const z_t z = z_t::Random();
+      const Q_t Q = random_spd<n_states>(0.01);
+      const R_t R = random_spd<n_measurements>(0.1);
+      sc = nclkf.correct(nclkf.predict(sc, u, Q, dt), z, R);
+      sc_static = nclkf_static.correct(nclkf_static.predict(sc_static, u, Q, dt), z, R);
+    }
+    EXPECT_NEAR((sc.x - sc_static.x).norm(), 0.0, 1e-9);
+    EXPECT_NEAR((sc.P - sc_static.P).norm(), 0.0, 1e-9);
+  }
+
+  // contiguous indices
+  {
+    const NCLKF_partial<n_states, n_inputs, n_measurements, 3> nclkf(A, B, H, 2.0, {2, 3, 4});
+    const NCLKF_partial_static<n_states, n_inputs, n_measurements, 2, 3, 4> nclkf_static(A, B, H, 2.0);
+    const statecov_t sc0{x_t::Random(), random_spd<n_states>(1.0)};
+    const z_t z = z_t::Random();
+    const R_t R = random_spd<n_measurements>(0.1);
+    const statecov_t sc = nclkf.correct(sc0, z, R);
+    const statecov_t sc_static = nclkf_static.correct(sc0, z, R);
+    EXPECT_NEAR((sc.x - sc_static.x).norm(), 0.0, 1e-9);
+    EXPECT_NEAR((sc.P - sc_static.P).norm(), 0.0, 1e-9);
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, jlkf_nis) //{ */
+
+TEST(TESTSuite, jlkf_nis)
+{
+  // the incremental statistics of the NIS window have to be the same as when computed from scratch
+  NisBuffer buffer(7);
+  std::vector<double> values;
+  for (int it = 0; it < 100; it++)
+  {
+    const double nis = std::abs(10.0 * std::sin(0.7 * it)) + (it % 13 == 0 ? 100.0 : 0.0);
+    buffer.push_back(nis);
+    values.push_back(nis);
+    const auto first = values.end() - std::min<size_t>(values.size(), buffer.capacity());
+    double sum = 0.0;
+    for (auto v = first; v != values.end(); v++)
+      sum += *v;
+    EXPECT_NEAR(buffer.mean(), sum / (values.end() - first), 1e-9);
+    EXPECT_EQ(buffer.max(), *std::max_element(first, values.end()));
+  }
+
+  // without a jump, the JLKF has to give the same results as the LKF
+  using jlkf_t = JLKF<n_states, n_inputs, n_measurements, 2>;
+  const double dt = 0.1;
+  A_t A;
+  B_t B;
+  H_t H;
+  generate_system(A, B, H, dt);
+  H(0, 3) = 0.5;
+  const lkf_t lkf(A, B, H);
+  const jlkf_t jlkf([&A](double) { return A; }, [&B](double) { return B; }, H, ros::NodeHandle(), 1e9, 1e9);
+
+  const x_t x0 = x_t::Random();
+  const P_t P0 = random_spd<n_states>(1.0);
+  const statecov_t sc0{x0, P0};
+  jlkf_t::statecov_t jsc0;
+  jsc0.x = x0;
+  jsc0.P = P0;
+  jsc0.nis_buffer = std::make_shared<NisBuffer>(10);
+  const z_t z = z_t::Random();
+  const R_t R = random_spd<n_measurements>(0.1);
+  const statecov_t sc = lkf.correct(sc0, z, R);
+  const jlkf_t::statecov_t jsc = jlkf.correct(jsc0, z, R);
+  EXPECT_NEAR((sc.x - jsc.x).norm(), 0.0, 1e-9);
+  EXPECT_NEAR((sc.P - jsc.P).norm(), 0.0, 1e-9);
+  EXPECT_EQ(jsc.nis_buffer->size(), 1u);
+}
+
+//}
+
+/* TEST(TESTSuite, dkf_batch_correction) //{ */
+
+TEST(TESTSuite, dkf_batch_correction)
+{
+  const dkf_t dkf(A_t::Identity(), B_t::Zero());
+
+  std::vector<dkf_t::line_t> lines;
+  for (int it = 0; it < 20; it++)
+    lines.push_back({dkf_t::pt3_t::Random(), dkf_t::vec3_t::Random(), 0.1 + std::abs(std::sin(it))});
+  std::vector<dkf_t::plane_t> planes;
+  for (int it = 0; it < 5; it++)
+    planes.push_back({dkf_t::pt3_t::Random(), dkf_t::vec3_t::Random(), 0.1 + std::abs(std::cos(it))});
+
+  const dkf_t::statecov_t sc0{dkf_t::x_t::Random(), random_spd<n_states>(1.0)};
+
+  // the reference - one correction per measurement
+  dkf_t::statecov_t sc_seq = sc0;
+  for (const auto& line : lines)
+    sc_seq = dkf.correctLine(sc_seq, line.origin, line.direction, line.variance);
+  for (const auto& plane : planes)
+    sc_seq = dkf.correctPlane(sc_seq, plane.origin, plane.normal, plane.variance);
+
+  const dkf_t::statecov_t sc_batch = dkf.correctBatch(sc0, lines, planes);
+  EXPECT_NEAR((sc_batch.x - sc_seq.x).norm(), 0.0, 1e-6);
+  EXPECT_NEAR((sc_batch.P - sc_seq.P).norm(), 0.0, 1e-6);
+  EXPECT_TRUE(sc_batch.P.isApprox(sc_batch.P.transpose()));
+
+  // a single measurement is the same as the non-batch version
+  const auto sc_line = dkf.correctLine(sc0, lines.front().origin, lines.front().direction, lines.front().variance);
+  const auto sc_line_batch = dkf.correctBatch(sc0, {lines.front()});
+  EXPECT_NEAR((sc_line_batch.x - sc_line.x).norm(), 0.0, 1e-9);
+  EXPECT_NEAR((sc_line_batch.P - sc_line.P).norm(), 0.0, 1e-9);
+
+  // no measurements - no change
+  const auto sc_empty = dkf.correctBatch(sc0, {}, {});
+  EXPECT_EQ(sc_empty.x, sc0.x);
+  EXPECT_EQ(sc_empty.P, sc0.P);
+}
+
+//}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -1,9 +1,13 @@
 #include <mrs_lib/median_filter.h>
+#include <mrs_lib/median_filter_n.h>
 #include <iostream>
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <deque>
 #include <random>
+#include <vector>
 
 /* randd() //{ */
 
@@ -178,6 +182,118 @@ TEST(TESTSuite, copy)
 
 //}
 
+/* TEST(TESTSuite, sliding_window) //{ */
+
+// reference median of the last bfr_len values
+double brute_force_median(std::vector<double> values)
+{
+  std::sort(std::begin(values), std::end(values));
+  const size_t n = values.size();
+  return n % 2 == 0 ? (values.at(n / 2 - 1) + values.at(n / 2)) / 2.0 : values.at(n / 2);
+}
+
+TEST(TESTSuite, sliding_window)
+{
+  constexpr size_t bfr_len = 20;
+  mrs_lib::MedianFilter fil(bfr_len);
+  std::deque<double> window;
+
+  std::mt19937 gen(42);
+  // a small range of integers to test the handling of duplicate values
+  std::uniform_int_distribution<int> rand_val(-5, 5);
+  for (int it = 0; it < 1000; it++)
+  {
+    const double value = rand_val(gen);
+    fil.add(value);
+    window.push_back(value);
+    if (window.size() > bfr_len)
+      window.pop_front();
+    ASSERT_EQ(fil.median(), brute_force_median({std::begin(window), std::end(window)}));
+  }
+
+  // shrinking the buffer discards the newest values
+  fil.setBufferLength(7);
+  window.resize(7);
+  EXPECT_EQ(fil.median(), brute_force_median({std::begin(window), std::end(window)}));
+  for (int it = 0; it < 100; it++)
+  {
+    const double value = rand_val(gen);
+    fil.add(value);
+    window.push_back(value);
+    window.pop_front();
+    ASSERT_EQ(fil.median(), brute_force_median({std::begin(window), std::end(window)}));
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, multi_channel) //{ */
+
+TEST(TESTSuite, multi_channel)
+{
+  constexpr size_t bfr_len = 10;
+  using fil_n_t = mrs_lib::MedianFilterN<3>;
+  using vec_t = fil_n_t::vec_t;
+  const vec_t min(-4, -10, -10);
+  const vec_t max(10, 4, 10);
+  const vec_t max_diff(20, 20, 3);
+  fil_n_t fil_n(bfr_len, min, max, max_diff);
+  std::vector<mrs_lib::MedianFilter> fils;
+  for (int ch = 0; ch < 3; ch++)
+    fils.emplace_back(bfr_len, min(ch), max(ch), max_diff(ch));
+
+  EXPECT_FALSE(fil_n.full());
+  EXPECT_TRUE(fil_n.median().array().isNaN().all());
+
+  // each channel should be filtered the same way as by a single-channel filter
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> rand_val(-5, 5);
+  for (int it = 0; it < 1000; it++)
+  {
+    const vec_t value(rand_val(gen), rand_val(gen), rand_val(gen));
+    const fil_n_t::mask_t valid = fil_n.addCheck(value);
+    for (int ch = 0; ch < 3; ch++)
+    {
+      ASSERT_EQ(valid(ch), fils.at(ch).addCheck(value(ch)));
+      ASSERT_EQ(fil_n.median()(ch), fils.at(ch).median());
+    }
+  }
+  EXPECT_TRUE(fil_n.full());
+
+  // shrinking the buffer discards the same values
+  fil_n.setBufferLength(5);
+  for (int ch = 0; ch < 3; ch++)
+  {
+    fils.at(ch).setBufferLength(5);
+    EXPECT_EQ(fil_n.median()(ch), fils.at(ch).median());
+  }
+  for (int it = 0; it < 100; it++)
+  {
+    const vec_t value(rand_val(gen), rand_val(gen), rand_val(gen));
+    fil_n.add(value);
+    for (int ch = 0; ch < 3; ch++)
+    {
+      fils.at(ch).add(value(ch));
+      ASSERT_EQ(fil_n.median()(ch), fils.at(ch).median());
+    }
+  }
+
+  fil_n.clear();
+  EXPECT_FALSE(fil_n.full());
+  EXPECT_TRUE(fil_n.median().array().isNaN().all());
+  EXPECT_TRUE(fil_n.addCheck(vec_t(1, 2, 3)).all());
+  EXPECT_EQ(fil_n.median(), vec_t(1, 2, 3));
+
+  // empty constructor that will construct an object with a zero-length buffer
+  fil_n_t fil_n2;
+  EXPECT_FALSE(fil_n2.initialized());
+  EXPECT_TRUE(fil_n2.full());
+  fil_n2.add(vec_t(1, 2, 3));
+  EXPECT_TRUE(fil_n2.median().array().isNaN().all());
+}
+
+//}
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 {
   // initialize the random number generator
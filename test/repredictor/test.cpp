@@ -4,10 +4,13 @@
 
 // Include the Repredictor header
 #include <mrs_lib/repredictor.h>
+#include <mrs_lib/repredictor_concurrent.h>
+#include <mrs_lib/repredictor_multi.h>
 // As a model, we'll use a LKF variant
 #include <mrs_lib/lkf.h>
 #include <random>
 #include <fstream>
+#include <thread>
 #include <ros/ros.h>
 
 #include <gtest/gtest.h>
@@ -23,6 +26,10 @@ namespace mrs_lib
   using lkf_t = varstepLKF<n_states, n_inputs, n_measurements>;
   using rep_t = Repredictor<lkf_t>;
   using dumbrep_t = Repredictor<lkf_t, true>;
+  using conrep_t = RepredictorConcurrent<lkf_t>;
+  // a second measurement model, observing the whole state
+  using lkf2_t = varstepLKF<n_states, n_inputs, 2>;
+  using multirep_t = RepredictorMulti<lkf_t, lkf_t, lkf2_t>;
 }
 
 // Some helpful aliases to make writing of types shorter
@@ -502,6 +509,439 @@ TEST(TESTSuite, dumblkf_comparison2)
 
 //}
 
+/* TEST(TESTSuite, cached_reprediction) //{ */
+
+TEST(TESTSuite, cached_reprediction)
+{
+  // Generate initial state, input and time
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Random();
+  const ros::Time t0 = ros::Time(0);
+  // H will observe the position
+  const H_t H( (H_t() << 1, 0).finished() );
+  // process noise is just identity
+  const Q_t Q = 0.1*Q_t::Identity();
+  // measurement noise is just identity
+  const R_t R = 0.1*R_t::Identity();
+
+  const int n_pts = 3e2;
+  const int n_delay = 10;
+
+  // Instantiate the LKF model
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+
+  // both Repredictors get the same data, but only the first one is queried in between
+  // (so it uses its cached posteriors, which have to be invalidated correctly by the delayed data)
+  // the short history buffer also checks the removal of the oldest elements
+  const int hist_len = 50;
+  rep_t rep_queried(x0, P0, u0, Q, t0, lkf, hist_len);
+  rep_t rep_lazy(x0, P0, u0, Q, t0, lkf, hist_len);
+
+  std::cout << "Running the Repredictors." << std::endl;
+  ros::Time stamp = t0;
+  for (int it = 1; it < n_pts; it++)
+  {
+    stamp += ros::Duration(std::abs(d(gen))/10.0);
+    if (d(gen) > 0.0)
+    {
+      // add a delayed measurement
+      const ros::Time meas_stamp = stamp - ros::Duration(std::abs(d(gen))/10.0*n_delay);
+      const z_t z = z_t::Random();
+      rep_queried.addMeasurement(z, R, meas_stamp);
+      rep_lazy.addMeasurement(z, R, meas_stamp);
+    }
+    else
+    {
+      const u_t u = u_t::Random();
+      rep_queried.addInputChangeWithNoise(u, Q, stamp);
+      rep_lazy.addInputChangeWithNoise(u, Q, stamp);
+    }
+
+    // query the state at the current time and sometimes also in the past
+    rep_queried.predictTo(stamp);
+    if (d(gen) > 1.0)
+      rep_queried.predictTo(stamp - ros::Duration(std::abs(d(gen))));
+  }
+
+  std::cout << "Evaluating results." << std::endl;
+  for (int it = 0; it < n_delay; it++)
+  {
+    const ros::Time to_stamp = stamp + ros::Duration(it*0.1);
+    const auto queried_sc = rep_queried.predictTo(to_stamp);
+    const auto lazy_sc = rep_lazy.predictTo(to_stamp);
+    const auto diff = (queried_sc.x-lazy_sc.x).norm();
+    const auto diffP = (queried_sc.P-lazy_sc.P).norm();
+    EXPECT_DOUBLE_EQ(diff, 0.0);
+    EXPECT_DOUBLE_EQ(diffP, 0.0);
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, concurrent_insertion) //{ */
+
+TEST(TESTSuite, concurrent_insertion)
+{
+  // Generate initial state, input and time
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Random();
+  const ros::Time t0 = ros::Time(0);
+  // H will observe the position
+  const H_t H( (H_t() << 1, 0).finished() );
+  // process noise is just identity
+  const Q_t Q = 0.1*Q_t::Identity();
+  // measurement noise is just identity
+  const R_t R = 0.1*R_t::Identity();
+
+  const int n_producers = 4;
+  const int n_pts = 2e2;
+
+  // Instantiate the LKF model
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+
+  // Prepare the data for each producer thread (every second one produces inputs, the others produce measurements)
+  std::vector<std::vector<std::tuple<ros::Time, u_t, z_t>>> data(n_producers);
+  for (int th = 0; th < n_producers; th++)
+  {
+    for (int it = 0; it < n_pts; it++)
+    {
+      // the stamps are unique for each thread and data point
+      const ros::Time stamp = t0 + ros::Duration(0.01*(1 + it*n_producers + th));
+      data.at(th).push_back({stamp, u_t::Random(), z_t::Random()});
+    }
+  }
+
+  // the history buffer is long enough for all the data so that the result is independent of the insertion order
+  const int hist_len = n_producers*n_pts + 1;
+  conrep_t conrep(x0, P0, u0, Q, t0, lkf, hist_len);
+  rep_t rep(x0, P0, u0, Q, t0, lkf, hist_len);
+
+  std::cout << "Running the producer threads." << std::endl;
+  std::vector<std::thread> producers;
+  for (int th = 0; th < n_producers; th++)
+  {
+    producers.emplace_back([&conrep, &data, &Q, &R, th]()
+    {
+      for (const auto& [stamp, u, z] : data.at(th))
+      {
+        if (th % 2)
+          conrep.addMeasurement(z, R, stamp);
+        else
+          conrep.addInputChangeWithNoise(u, Q, stamp);
+      }
+    });
+  }
+  // query the state in the meantime
+  for (int it = 0; it < n_pts; it++)
+    conrep.predictTo(t0 + ros::Duration(0.01*it));
+  for (auto& producer : producers)
+    producer.join();
+
+  // feed the same data to a standard Repredictor sequentially
+  for (int th = 0; th < n_producers; th++)
+  {
+    for (const auto& [stamp, u, z] : data.at(th))
+    {
+      if (th % 2)
+        rep.addMeasurement(z, R, stamp);
+      else
+        rep.addInputChangeWithNoise(u, Q, stamp);
+    }
+  }
+
+  std::cout << "Evaluating results." << std::endl;
+  for (int it = 0; it <= n_producers*n_pts; it += n_producers)
+  {
+    const ros::Time to_stamp = t0 + ros::Duration(0.01*it + 0.005);
+    const auto conrep_sc = conrep.predictTo(to_stamp);
+    const auto rep_sc = rep.predictTo(to_stamp);
+    const auto diff = (conrep_sc.x-rep_sc.x).norm();
+    const auto diffP = (conrep_sc.P-rep_sc.P).norm();
+    EXPECT_DOUBLE_EQ(diff, 0.0);
+    EXPECT_DOUBLE_EQ(diffP, 0.0);
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, batch_insertion) //{ */
+
+TEST(TESTSuite, batch_insertion)
+{
+  // Generate initial state, input and time
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Random();
+  const ros::Time t0 = ros::Time(0);
+  // H will observe the position
+  const H_t H( (H_t() << 1, 0).finished() );
+  // process noise is just identity
+  const Q_t Q = 0.1*Q_t::Identity();
+  // measurement noise is just identity
+  const R_t R = 0.1*R_t::Identity();
+
+  const int n_pts = 3e2;
+  const int batch_size = 10;
+
+  // Instantiate the LKF model
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+
+  // the measurements are added in batches to the first Repredictor and one by one to the second one
+  // the first one has a short history buffer to check the removal of the oldest elements, which should not change the result
+  rep_t rep_batch(x0, P0, u0, Q, t0, lkf, 6*batch_size);
+  rep_t rep_single(x0, P0, u0, Q, t0, lkf, 3*n_pts);
+
+  std::cout << "Running the Repredictors." << std::endl;
+  ros::Time stamp = t0;
+  for (int it = 1; it < n_pts; it++)
+  {
+    stamp += ros::Duration(0.1);
+    const u_t u = u_t::Random();
+    rep_batch.addInputChangeWithNoise(u, Q, stamp);
+    rep_single.addInputChangeWithNoise(u, Q, stamp);
+
+    if (it % batch_size == 0)
+    {
+      // generate a burst of delayed measurements from the last batch_size inputs
+      std::vector<rep_t::measurement_t> meass;
+      for (int meas_it = 0; meas_it < batch_size; meas_it++)
+      {
+        const ros::Time meas_stamp = stamp - ros::Duration(std::abs(d(gen))/4.0*batch_size*0.1);
+        meass.push_back({z_t::Random(), R, meas_stamp});
+        rep_single.addMeasurement(meass.back().z, R, meas_stamp);
+      }
+      rep_batch.addMeasurements(meass);
+    }
+
+    // query the state at the current time
+    if (d(gen) > 0.0)
+      rep_batch.predictTo(stamp);
+  }
+
+  std::cout << "Evaluating results." << std::endl;
+  for (int it = 0; it < batch_size; it++)
+  {
+    const ros::Time to_stamp = stamp + ros::Duration(it*0.1);
+    const auto batch_sc = rep_batch.predictTo(to_stamp);
+    const auto single_sc = rep_single.predictTo(to_stamp);
+    const auto diff = (batch_sc.x-single_sc.x).norm();
+    const auto diffP = (batch_sc.P-single_sc.P).norm();
+    EXPECT_DOUBLE_EQ(diff, 0.0);
+    EXPECT_DOUBLE_EQ(diffP, 0.0);
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, rts_smoothing) //{ */
+
+TEST(TESTSuite, rts_smoothing)
+{
+  // Generate initial state, input and time
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Random();
+  const ros::Time t0 = ros::Time(0);
+  // H will observe the position
+  const H_t H( (H_t() << 1, 0).finished() );
+  // process noise is just identity
+  const Q_t Q = 0.1*Q_t::Identity();
+  // measurement noise is just identity
+  const R_t R = 0.1*R_t::Identity();
+
+  const int n_pts = 1e2;
+
+  // Instantiate the LKF model
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+  rep_t rep(x0, P0, u0, Q, t0, lkf, 2*n_pts);
+
+  // run a standard LKF forward pass, keeping the predicted and corrected states
+  std::vector<ros::Time> stamps = {t0};
+  std::vector<double> dts;
+  std::vector<statecov_t> preds;
+  std::vector<statecov_t> posts = {{x0, P0}};
+  u_t u = u0;
+  for (int it = 1; it < n_pts; it++)
+  {
+    const double dt = std::abs(d(gen));
+    const z_t z = z_t::Random();
+    dts.push_back(dt);
+    stamps.push_back(stamps.back() + ros::Duration(dt));
+    preds.push_back(lkf->predict(posts.back(), u, Q, dt));
+    posts.push_back(lkf->correct(preds.back(), z, R));
+
+    // feed the same data to the Repredictor in a random order
+    if (d(gen) > 0.0)
+    {
+      rep.addMeasurement(z, R, stamps.back());
+      rep.addInputChangeWithNoise(u, Q, stamps.at(stamps.size()-2));
+    }
+    else
+    {
+      rep.addInputChangeWithNoise(u, Q, stamps.at(stamps.size()-2));
+      rep.addMeasurement(z, R, stamps.back());
+    }
+    u = u_t::Random();
+    // the smoothed estimates have to be invalidated correctly
+    if (d(gen) > 1.0)
+      rep.smoothTo(stamps.at(stamps.size()/2));
+  }
+
+  // run the standard RTS backward pass
+  std::vector<statecov_t> smoothed(n_pts);
+  smoothed.back() = posts.back();
+  for (int it = n_pts-2; it >= 0; it--)
+  {
+    const A_t A = generateA(dts.at(it));
+    const P_t C = posts.at(it).P * A.transpose() * preds.at(it).P.inverse();
+    smoothed.at(it).x = posts.at(it).x + C*(smoothed.at(it+1).x - preds.at(it).x);
+    smoothed.at(it).P = posts.at(it).P + C*(smoothed.at(it+1).P - preds.at(it).P)*C.transpose();
+  }
+
+  std::cout << "Evaluating results." << std::endl;
+  const auto rep_smoothed = rep.smoothedHistory(stamps.back() - stamps.at(n_pts/2));
+  // each stamp corresponds to a measurement and an input, except for the newest one
+  ASSERT_EQ(rep_smoothed.size(), 2*(n_pts - n_pts/2) - 1);
+  for (const auto& rep_sc : rep_smoothed)
+  {
+    const int it = std::lower_bound(std::begin(stamps), std::end(stamps), rep_sc.stamp) - std::begin(stamps);
+    ASSERT_EQ(stamps.at(it), rep_sc.stamp);
+    EXPECT_NEAR((smoothed.at(it).x-rep_sc.x).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((smoothed.at(it).P-rep_sc.P).norm(), 0.0, 1e-6);
+    // smoothing should never increase the uncertainty
+    EXPECT_LE(rep_sc.P.trace(), posts.at(it).P.trace() + 1e-9);
+  }
+  for (int it = 1; it < n_pts; it++)
+  {
+    const auto rep_sc = rep.smoothTo(stamps.at(it));
+    EXPECT_NEAR((smoothed.at(it).x-rep_sc.x).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((smoothed.at(it).P-rep_sc.P).norm(), 0.0, 1e-6);
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, multi_model) //{ */
+
+TEST(TESTSuite, multi_model)
+{
+  // Generate initial state, input and time
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Random();
+  const ros::Time t0 = ros::Time(0);
+  // H will observe the position for the first model and the whole state for the second one
+  const H_t H( (H_t() << 1, 0).finished() );
+  const lkf2_t::H_t H2 = lkf2_t::H_t::Identity();
+  // process noise is just identity
+  const Q_t Q = 0.1*Q_t::Identity();
+  // measurement noise is just identity
+  const R_t R = 0.1*R_t::Identity();
+  const lkf2_t::R_t R2 = 0.1*lkf2_t::R_t::Identity();
+
+  const int n_pts = 1e2;
+
+  // Instantiate the LKF models
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+  auto lkf2 = std::make_shared<lkf2_t>(generateA, generateB, H2);
+  // a short history buffer to also test throwing out of the old elements
+  multirep_t rep(x0, P0, u0, Q, t0, lkf, {lkf, lkf2}, 10);
+
+  // run a standard LKF, switching randomly between the measurement models
+  statecov_t sc = {x0, P0};
+  ros::Time stamp = t0;
+  u_t u = u0;
+  for (int it = 1; it < n_pts; it++)
+  {
+    const double dt = std::abs(d(gen));
+    const ros::Time prev_stamp = stamp;
+    stamp += ros::Duration(dt);
+    sc = lkf->predict(sc, u, Q, dt);
+    const bool full = d(gen) > 0.0;
+    if (full)
+    {
+      const lkf2_t::z_t z = lkf2_t::z_t::Random();
+      const auto corrected = lkf2->correct({sc.x, sc.P}, z, R2);
+      sc.x = corrected.x;
+      sc.P = corrected.P;
+      rep.addMeasurement<1>(z, R2, stamp);
+    }
+    else
+    {
+      const z_t z = z_t::Random();
+      sc = lkf->correct(sc, z, R);
+      rep.addMeasurement<0>(z, R, stamp);
+    }
+    // the system input is added after the measurement, which follows it
+    rep.addInputChangeWithNoise(u, Q, prev_stamp);
+    u = u_t::Random();
+
+    const auto rep_sc = rep.predictTo(stamp);
+    EXPECT_NEAR((sc.x-rep_sc.x).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((sc.P-rep_sc.P).norm(), 0.0, 1e-6);
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, statistics) //{ */
+
+TEST(TESTSuite, statistics)
+{
+  // Generate initial state, input and time
+  const x_t x0 = x_t::Zero();
+  const P_t P0 = 10.0*P_t::Identity();
+  const u_t u0 = u_t::Random();
+  const ros::Time t0 = ros::Time(0);
+  // H will observe the position
+  const H_t H( (H_t() << 1, 0).finished() );
+  const Q_t Q = 0.1*Q_t::Identity();
+  const R_t R = 0.1*R_t::Identity();
+
+  // Instantiate the LKF model
+  auto lkf = std::make_shared<lkf_t>(generateA, generateB, H);
+  rep_t rep(x0, P0, u0, Q, t0, lkf, 20);
+  rep.setDelayHistogram(ros::Duration(0.1), 5);
+
+  // add some inputs at 10Hz
+  ros::Time stamp = t0;
+  for (int it = 0; it < 9; it++)
+  {
+    stamp += ros::Duration(0.1);
+    rep.addInputChangeWithNoise(u0, Q, stamp);
+  }
+  rep.predictTo(stamp);
+
+  // an in-sequence measurement, two delayed ones, one delayed beyond the histogram and one older than the buffer
+  // (the delays are 0.17s, 0.32s, 0.8s and 1.95s w.r.t. the in-sequence measurement)
+  rep.addMeasurement(z_t::Random(), R, stamp + ros::Duration(0.05));
+  rep.addMeasurement(z_t::Random(), R, stamp - ros::Duration(0.12));
+  rep.addMeasurements(std::vector<rep_t::measurement_t>{{z_t::Random(), R, stamp - ros::Duration(0.27)}, {z_t::Random(), R, stamp - ros::Duration(0.75)}});
+  rep.addMeasurement(z_t::Random(), R, t0 - ros::Duration(1.0));
+  rep.predictTo(stamp + ros::Duration(0.1));
+
+  const auto stats = rep.getStatistics();
+  EXPECT_EQ(stats.n_measurements, 5u);
+  EXPECT_EQ(stats.n_out_of_sequence, 4u);
+  EXPECT_EQ(stats.n_dropped, 1u);
+  EXPECT_NEAR(stats.max_delay, 1.0 + 0.9 + 0.05, 1e-9);
+  EXPECT_EQ(stats.delay_histogram, std::vector<uint64_t>({1, 1, 0, 1, 2}));
+  EXPECT_EQ(stats.n_predictions, 2u);
+  // the first prediction replays the whole buffer except for the oldest point (9 points), the second one
+  // all points from the oldest added measurement onward (12 points)
+  EXPECT_EQ(stats.n_replayed, 21u);
+  EXPECT_EQ(stats.max_replayed, 12u);
+  EXPECT_GE(stats.replay_time, stats.max_replay_time);
+
+  rep.resetStatistics();
+  EXPECT_EQ(rep.getStatistics().n_measurements, 0u);
+  EXPECT_EQ(rep.getStatistics().delay_histogram, std::vector<uint64_t>(5, 0));
+}
+
+//}
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
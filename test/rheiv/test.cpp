@@ -0,0 +1,196 @@
+// clang: MatousFormat
+
+#include <mrs_lib/rheiv.h>
+#include <cmath>
+#include <deque>
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace mrs_lib
+{
+  const int n_states = 3;
+  const int n_params = 4;
+
+  using rheiv_t = RHEIV<n_states, n_params>;
+  using rheiv_streaming_t = RHEIV_streaming<n_states, n_params>;
+}  // namespace mrs_lib
+
+using namespace mrs_lib;
+using x_t = rheiv_t::x_t;
+using xs_t = rheiv_t::xs_t;
+using zs_t = rheiv_t::zs_t;
+using P_t = rheiv_t::P_t;
+using Ps_t = rheiv_t::Ps_t;
+using dzdx_t = rheiv_t::dzdx_t;
+using theta_t = rheiv_t::theta_t;
+
+template class mrs_lib::RHEIV_streaming<n_states, n_params>;
+
+// for the plane surface model, there is no need to transform the data
+zs_t f_z(const xs_t& xs)
+{
+  return xs;
+}
+
+// the parameters are only defined up to a scale, so the sign may differ
+double theta_diff(const theta_t& th1, const theta_t& th2)
+{
+  return std::min((th1 - th2).norm(), (th1 + th2).norm());
+}
+
+// generates a noisy sample of the plane 0.3x - 0.2y + z - 5 = 0 and its covariance
+std::pair<x_t, P_t> generate_sample(std::mt19937& gen)
+{
+  std::uniform_real_distribution<> pos(-10.0, 10.0);
+  std::normal_distribution<> noise(0.0, 0.1);
+  x_t x;
+  x.x() = pos(gen);
+  x.y() = pos(gen);
+  x.z() = 5.0 - 0.3 * x.x() + 0.2 * x.y() + noise(gen);
+  const P_t tmp = P_t::Random();
+  const P_t P = 0.01 * (tmp * tmp.transpose() + P_t::Identity());
+  return {x, P};
+}
+
+/* TEST(TESTSuite, streaming) //{ */
+
+TEST(TESTSuite, streaming)
+{
+  std::mt19937 gen(42);
+  const int window_length = 200;
+  const int n_new = 10;
+
+  const dzdx_t dzdx = dzdx_t::Identity();
+  rheiv_t rheiv(f_z, dzdx, 1e-12, 100u);
+  rheiv_streaming_t rheiv_streaming(f_z, dzdx, 1e-12, 100u);
+  rheiv_streaming.set_window_length(window_length);
+
+  std::deque<std::pair<x_t, P_t>> window;
+  for (int frame = 0; frame < 50; frame++)
+  {
+    xs_t xs_new(n_states, n_new);
+    Ps_t Ps_new;
+    for (int it = 0; it < n_new; it++)
+    {
+      const auto [x, P] = generate_sample(gen);
+      xs_new.col(it) = x;
+      Ps_new.push_back(P);
+      window.push_back({x, P});
+    }
+    while (window.size() > window_length)
+      window.pop_front();
+    rheiv_streaming.add(xs_new, Ps_new);
+    ASSERT_EQ(rheiv_streaming.size(), window.size());
+
+    // the reference - the whole window is passed to the standard RHEIV
+    xs_t xs(n_states, window.size());
+    Ps_t Ps;
+    for (size_t it = 0; it < window.size(); it++)
+    {
+      xs.col(it) = window.at(it).first;
+      Ps.push_back(window.at(it).second);
+    }
+    const theta_t theta = rheiv.fit(xs, Ps);
+    const theta_t theta_streaming = rheiv_streaming.fit();
+    EXPECT_NEAR(theta_diff(theta, theta_streaming), 0.0, 1e-6);
+  }
+
+  // the estimate should be close to the true plane
+  const theta_t theta_true = theta_t(0.3, -0.2, 1.0, -5.0).normalized();
+  EXPECT_NEAR(theta_diff(rheiv_streaming.get_last_estimate(), theta_true), 0.0, 1e-2);
+
+  // retiring all the samples resets the warm start and the fit is initialized using ALS again
+  rheiv_streaming.remove(rheiv_streaming.size());
+  EXPECT_EQ(rheiv_streaming.size(), 0u);
+  for (int it = 0; it < 10; it++)
+  {
+    const auto [x, P] = generate_sample(gen);
+    rheiv_streaming.add(x, P);
+  }
+  EXPECT_NO_THROW(rheiv_streaming.fit());
+}
+
+//}
+
+/* TEST(TESTSuite, parallel) //{ */
+
+TEST(TESTSuite, parallel)
+{
+  std::mt19937 gen(42);
+  const int n_pts = 5000;
+
+  xs_t xs(n_states, n_pts);
+  Ps_t Ps;
+  for (int it = 0; it < n_pts; it++)
+  {
+    const auto [x, P] = generate_sample(gen);
+    xs.col(it) = x;
+    Ps.push_back(P);
+  }
+
+  const dzdx_t dzdx = dzdx_t::Identity();
+  rheiv_t rheiv(f_z, dzdx, 1e-12, 100u);
+  rheiv_t rheiv_parallel(f_z, dzdx, 1e-12, 100u);
+  rheiv_parallel.set_parallel_evaluation(3);
+
+  // the partial sums are reduced in a fixed order, so the results should be identical
+  const theta_t theta = rheiv.fit(xs, Ps);
+  const theta_t theta_parallel = rheiv_parallel.fit(xs, Ps);
+  EXPECT_EQ(theta, theta_parallel);
+
+  const theta_t theta_true = theta_t(0.3, -0.2, 1.0, -5.0).normalized();
+  EXPECT_NEAR(theta_diff(theta_parallel, theta_true), 0.0, 1e-2);
+}
+
+//}
+
+/* TEST(TESTSuite, ransac) //{ */
+
+TEST(TESTSuite, ransac)
+{
+  std::mt19937 gen(42);
+  const int n_pts = 2000;
+  const int n_outliers = 600;
+
+  // the outliers are uniformly distributed in a box around the plane
+  std::uniform_real_distribution<> pos(-10.0, 10.0);
+  xs_t xs(n_states, n_pts);
+  Ps_t Ps;
+  for (int it = 0; it < n_pts; it++)
+  {
+    const auto [x, P] = generate_sample(gen);
+    xs.col(it) = x;
+    Ps.push_back(P);
+    if (it < n_outliers)
+      xs.col(it).z() = 5.0 + 2.0 * pos(gen);
+  }
+
+  const dzdx_t dzdx = dzdx_t::Identity();
+  rheiv_t rheiv(f_z, dzdx, 1e-12, 100u);
+  const theta_t theta_true = theta_t(0.3, -0.2, 1.0, -5.0).normalized();
+
+  // the outliers spoil the plain fit
+  const theta_t theta = rheiv.fit(xs, Ps);
+  EXPECT_GT(theta_diff(theta, theta_true), 1e-2);
+
+  const theta_t theta_robust = rheiv.fit_RANSAC(xs, Ps);
+  EXPECT_NEAR(theta_diff(theta_robust, theta_true), 0.0, 1e-2);
+  // all the inliers should be found and only a few outliers may be close enough to the plane
+  const auto& inliers = rheiv.get_inliers();
+  EXPECT_GE(inliers.size(), size_t(0.95 * (n_pts - n_outliers)));
+  EXPECT_LE(inliers.size(), size_t(n_pts - n_outliers + 0.1 * n_outliers));
+
+  // the fit is repeatable and the parallel scoring gives the same result
+  rheiv.set_parallel_evaluation(3);
+  EXPECT_EQ(rheiv.fit_RANSAC(xs, Ps), theta_robust);
+}
+
+//}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -17,6 +17,7 @@ namespace mrs_lib
   const int n_measurements = 2;
 
   using ukf_t = UKF<n_states, n_inputs, n_measurements>;
+  using sqrtukf_t = sqrtUKF<n_states, n_inputs, n_measurements>;
   using lkf_t = LKF<n_states, n_inputs, n_measurements>;
 }  // namespace mrs_lib
 
@@ -35,6 +36,7 @@ using B_t = lkf_t::B_t;
 using H_t = lkf_t::H_t;
 
 template class mrs_lib::UKF<n_states, n_inputs, n_measurements>;
+template class mrs_lib::sqrtUKF<n_states, n_inputs, n_measurements>;
 template class mrs_lib::LKF<n_states, n_inputs, n_measurements>;
 
 H_t H;
@@ -210,6 +212,125 @@ TEST(TESTSuite, main_test) {
 
 //}
 
+/* TEST(TESTSuite, batch_models) //{ */
+
+TEST(TESTSuite, batch_models)
+{
+  H << 1, 0, 0, 0, 0, 1, 0, 0;
+  const double dt = 0.1;
+  const Q_t Q = 1e-2 * Q_t::Identity();
+  const R_t R = 1e-2 * R_t::Identity();
+
+  // the same models as tra_model_f and obs_model_f, vectorized over the sigma points
+  const ukf_t::batch_transition_model_t tra_model_batch = [](const ukf_t::X_t& X, const u_t& u, const double dt) {
+    ukf_t::X_t ret = X;
+    ret.row(x_x) += dt * (X.row(x_alpha).array().cos() * X.row(x_speed).array()).matrix();
+    ret.row(x_y) += dt * (X.row(x_alpha).array().sin() * X.row(x_speed).array()).matrix();
+    ret.row(x_alpha).array() += dt * u(u_alpha);
+    return ret;
+  };
+  const ukf_t::batch_observation_model_t obs_model_batch = [](const ukf_t::X_t& X) { return ukf_t::Z_t(H * X); };
+
+  const ukf_t ukf(tra_model_f, obs_model_f);
+  ukf_t ukf_batch(nullptr, nullptr);
+  ukf_batch.setBatchTransitionModel(tra_model_batch);
+  ukf_batch.setBatchObservationModel(obs_model_batch);
+
+  P_t P_tmp = P_t::Random();
+  ukf_t::statecov_t sc{x_t::Random(), P_tmp * P_tmp.transpose() + P_t::Identity()};
+  ukf_t::statecov_t sc_batch = sc;
+  for (int it = 0; it < 20; it++)
+  {
+    const u_t u = u_t::Random();
+    const z_t z = z_t::Random();
+    sc = ukf.correct(ukf.predict(sc, u, Q, dt), z, R);
+    sc_batch = ukf_batch.correct(ukf_batch.predict(sc_batch, u, Q, dt), z, R);
+    // the vectorized sin and cos may differ slightly from the scalar ones
+    EXPECT_NEAR((sc.x - sc_batch.x).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((sc.P - sc_batch.P).norm(), 0.0, 1e-6);
+  }
+}
+
+//}
+
+/* TEST(TESTSuite, parallel_evaluation) //{ */
+
+TEST(TESTSuite, parallel_evaluation)
+{
+  H << 1, 0, 0, 0, 0, 1, 0, 0;
+  const double dt = 0.1;
+  const Q_t Q = 1e-2 * Q_t::Identity();
+  const R_t R = 1e-2 * R_t::Identity();
+
+  const ukf_t ukf(tra_model_f, obs_model_f);
+  ukf_t ukf_par(tra_model_f, obs_model_f);
+  ukf_par.setParallelEvaluation(4);
+
+  P_t P_tmp = P_t::Random();
+  ukf_t::statecov_t sc{x_t::Random(), P_tmp * P_tmp.transpose() + P_t::Identity()};
+  ukf_t::statecov_t sc_par = sc;
+  for (int it = 0; it < 50; it++)
+  {
+    const u_t u = u_t::Random();
+    const z_t z = z_t::Random();
+    sc = ukf.correct(ukf.predict(sc, u, Q, dt), z, R);
+    sc_par = ukf_par.correct(ukf_par.predict(sc_par, u, Q, dt), z, R);
+    // the results have to be exactly the same
+    EXPECT_EQ(sc.x, sc_par.x);
+    EXPECT_EQ(sc.P, sc_par.P);
+  }
+
+  // an exception thrown by the model is propagated to the caller
+  ukf_par.setObservationModel([](const x_t& x) -> z_t {
+    if (x(x_x) > 0.0)
+      throw std::runtime_error("test");
+    return H * x;
+  });
+  sc_par.x(x_x) = 0.0;
+  EXPECT_THROW(ukf_par.correct(sc_par, z_t::Zero(), R), std::runtime_error);
+}
+
+//}
+
+/* TEST(TESTSuite, sqrt_ukf) //{ */
+
+TEST(TESTSuite, sqrt_ukf)
+{
+  H << 1, 0, 0, 0, 0, 1, 0, 0;
+  const double dt = 0.1;
+  const Q_t Q = 1e-2 * Q_t::Identity();
+  const R_t R = 1e-2 * R_t::Identity();
+
+  const ukf_t ukf(tra_model_f, obs_model_f);
+  const sqrtukf_t sqrtukf(tra_model_f, obs_model_f);
+
+  P_t P_tmp = P_t::Random();
+  ukf_t::statecov_t sc{x_t::Random(), P_tmp * P_tmp.transpose() + P_t::Identity()};
+  // the same filter using the square-root form and using the full covariance interface
+  sqrtukf_t::sqrt_statecov_t ssc = sqrtukf_t::toSqrt(sc);
+  ukf_t::statecov_t sc_full = sc;
+  for (int it = 0; it < 50; it++)
+  {
+    const u_t u = u_t::Random();
+    const z_t z = z_t::Random();
+    sc = ukf.correct(ukf.predict(sc, u, Q, dt), z, R);
+    ssc = sqrtukf.correct(sqrtukf.predict(ssc, u, Q, dt), z, R);
+    sc_full = sqrtukf.correct(sqrtukf.predict(sc_full, u, Q, dt), z, R);
+
+    // the factor has to stay lower-triangular with a positive diagonal
+    EXPECT_TRUE(ssc.S.isLowerTriangular());
+    EXPECT_GT(ssc.S.diagonal().minCoeff(), 0.0);
+
+    const ukf_t::statecov_t ssc_full = sqrtukf_t::fromSqrt(ssc);
+    EXPECT_NEAR((sc.x - ssc_full.x).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((sc.P - ssc_full.P).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((sc.x - sc_full.x).norm(), 0.0, 1e-6);
+    EXPECT_NEAR((sc.P - sc_full.P).norm(), 0.0, 1e-6);
+  }
+}
+
+//}
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
 
   testing::InitGoogleTest(&argc, argv);